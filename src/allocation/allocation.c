@@ -2,11 +2,12 @@
 #define _GNU_SOURCE
 #include "allocation.h"
 
-#include <assert.h>
-
+#include "allocation_guard.h"
 #include "allocation_internal.h"
+#include "allocation_trace.h"
 #include <sys/mman.h>
 #include <linux/mman.h>
+#include <pthread.h>
 #include <unistd.h>
 #include <dirent.h>
 #include <math.h>
@@ -87,96 +88,344 @@ static const struct page_type_entry* get_page_type_best_for_size(size_t size) {
     return prev;
 }
 
+// Every chunk header and user pointer sits on a 16 byte boundary, like malloc's
+#define ALIGNMENT 16
+#define ALIGN_UP(value) (((value) + ALIGNMENT - 1) & ~(size_t) (ALIGNMENT - 1))
+#define PAGE_HEADER_SIZE ALIGN_UP(sizeof(struct page_metadata))
+#define CHUNK_HEADER_SIZE ALIGN_UP(sizeof(struct chunk_metadata))
+// Small allocations share pages of at least this many bytes instead of getting a mapping each
+#define MIN_MAPPING_SIZE (256 * 1024)
+// Splitting off less than this would leave a free chunk too small to be worth tracking
+#define MIN_SPLIT_SIZE (CHUNK_HEADER_SIZE + ALIGNMENT)
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
 static struct page_metadata* head_page = NULL;
 static struct page_metadata* tail_page = NULL;
+static struct chunk_metadata* head_free = NULL;
 
-static struct chunk_metadata* find_free_chunk_of_size(size_t size) {
-    const struct chunk_metadata* chunk = head_page->head_chunk;
-    if (!chunk->is_free) {
-        chunk = chunk->next_free;
-    }
+static void* get_chunk_data(const struct chunk_metadata* chunk) {
+    return (char*) chunk + CHUNK_HEADER_SIZE;
+}
 
-    while (chunk != NULL) {
-        chunk = chunk->next_free;
-    }
+static struct chunk_metadata* get_chunk_of_data(const void* ptr) {
+    return (struct chunk_metadata*) ((char*) ptr - CHUNK_HEADER_SIZE);
+}
 
-    while (curr != NULL && free_space_entry == NULL) {
-        struct free_space_entry* entry = curr->free_space_list_head;
+static void push_free(struct chunk_metadata* chunk) {
+    chunk->is_free = true;
+    chunk->prev_free = NULL;
+    chunk->next_free = head_free;
+    if (head_free != NULL) {
+        head_free->prev_free = chunk;
+    }
+    head_free = chunk;
+}
 
-        while (entry != NULL) {
-            if (entry->size < size) {
-                entry = entry->next;
-                continue;
-            }
+static void unlink_free(struct chunk_metadata* chunk) {
+    if (chunk->prev_free != NULL) {
+        chunk->prev_free->next_free = chunk->next_free;
+    } else {
+        head_free = chunk->next_free;
+    }
+    if (chunk->next_free != NULL) {
+        chunk->next_free->prev_free = chunk->prev_free;
+    }
+    chunk->is_free = false;
+}
 
-            free_space_entry = entry;
-            break;
+// First fit across all pages
+static struct chunk_metadata* find_free_chunk_of_size(size_t size) {
+    for (struct chunk_metadata* chunk = head_free; chunk != NULL; chunk = chunk->next_free) {
+        if (chunk->size >= size) {
+            return chunk;
         }
-
-        curr = curr->next;
     }
 
-    return chunk;
+    return NULL;
 }
 
-static struct page_metadata* get_new_page(size_t size) {
-    const struct page_type_entry* page_type = get_page_type_best_for_size(size + sizeof(struct page_metadata) + sizeof(struct chunk_metadata) * 2);
-
+static void* map_page(const struct page_type_entry* page_type, size_t byte_count) {
     int flags = MAP_PRIVATE | MAP_ANONYMOUS;
     if (!page_type->is_normal_page) {
         flags |= MAP_HUGETLB;
-        flags |= page_type->flag;
+        flags |= page_type->flag << MAP_HUGE_SHIFT;
+    }
+
+    void* address = mmap(NULL, byte_count, PROT_READ | PROT_WRITE, flags, -1, 0);
+    return address == MAP_FAILED ? NULL : address;
+}
+
+// Maps a page with room for size bytes and adds its one big chunk to the free list
+static struct chunk_metadata* get_new_page(size_t size) {
+    size_t needed = size + PAGE_HEADER_SIZE + CHUNK_HEADER_SIZE;
+    if (needed < MIN_MAPPING_SIZE) {
+        needed = MIN_MAPPING_SIZE;
     }
 
-    const size_t byte_count = page_type->byte_size / ((page_type->byte_size + size - 1) / size);
-    const void* address = mmap(NULL, byte_count, PROT_READ | PROT_WRITE, flags, -1, 0);
-    struct page_metadata* page = (struct page_metadata*) address;
+    const struct page_type_entry* page_type = get_page_type_best_for_size(needed);
+    size_t byte_count = (needed + page_type->byte_size - 1) / page_type->byte_size * page_type->byte_size;
+    void* address = map_page(page_type, byte_count);
 
+    // Huge pages have to be reserved up front, fall back to normal ones when there are none left
+    if (address == NULL && !page_type->is_normal_page) {
+        page_type = &get_page_types()->array[0];
+        byte_count = (needed + page_type->byte_size - 1) / page_type->byte_size * page_type->byte_size;
+        address = map_page(page_type, byte_count);
+    }
+
+    if (address == NULL) {
+        return NULL;
+    }
+
+    struct page_metadata* page = address;
     page->size = byte_count;
     page->page_type = page_type;
+    page->prev = tail_page;
+    page->next = NULL;
 
-    struct chunk_metadata* chunk = (struct chunk_metadata*) (address + sizeof(struct page_metadata));
+    struct chunk_metadata* chunk = (struct chunk_metadata*) ((char*) address + PAGE_HEADER_SIZE);
     page->head_chunk = chunk;
     page->tail_chunk = chunk;
 
     chunk->page = page;
-    chunk->size = byte_count - sizeof(struct page_metadata);
+    chunk->size = byte_count - PAGE_HEADER_SIZE - CHUNK_HEADER_SIZE;
     chunk->prev = NULL;
     chunk->next = NULL;
+    push_free(chunk);
 
     if (tail_page != NULL) {
-        if (tail_page->tail_chunk->is_free) {
-            chunk->prev_free = tail_page->tail_chunk;
+        tail_page->next = page;
+    } else {
+        head_page = page;
+    }
+    tail_page = page;
+
+    return chunk;
+}
+
+static void release_page(struct page_metadata* page) {
+    unlink_free(page->head_chunk);
+
+    if (page->prev != NULL) {
+        page->prev->next = page->next;
+    } else {
+        head_page = page->next;
+    }
+    if (page->next != NULL) {
+        page->next->prev = page->prev;
+    } else {
+        tail_page = page->prev;
+    }
+
+    munmap(page, page->size);
+}
+
+// Cuts chunk down to size, giving the rest back as a free chunk if it's big enough to be useful
+static void split_chunk(struct chunk_metadata* chunk, size_t size) {
+    if (chunk->size < size + MIN_SPLIT_SIZE) {
+        return;
+    }
+
+    struct chunk_metadata* rest = (struct chunk_metadata*) ((char*) get_chunk_data(chunk) + size);
+    rest->page = chunk->page;
+    rest->size = chunk->size - size - CHUNK_HEADER_SIZE;
+    rest->prev = chunk;
+    rest->next = chunk->next;
+
+    if (chunk->next != NULL) {
+        chunk->next->prev = rest;
+    } else {
+        chunk->page->tail_chunk = rest;
+    }
+    chunk->next = rest;
+    chunk->size = size;
+
+    push_free(rest);
+
+    // The chunk after rest may already be free, keep neighbouring free chunks merged
+    if (rest->next != NULL && rest->next->is_free) {
+        struct chunk_metadata* next = rest->next;
+        unlink_free(next);
+        rest->size += CHUNK_HEADER_SIZE + next->size;
+        rest->next = next->next;
+        if (next->next != NULL) {
+            next->next->prev = rest;
         } else {
-            chunk->prev_free = tail_page->tail_chunk->prev_free;
+            rest->page->tail_chunk = rest;
         }
     }
+}
 
-    chunk->next_free = NULL;
+// Merges chunk with the free chunk right after it in the same page
+static void absorb_next(struct chunk_metadata* chunk) {
+    struct chunk_metadata* next = chunk->next;
+    unlink_free(next);
 
-    if (head_page == NULL) {
-        head_page = page;
-        tail_page = page;
+    chunk->size += CHUNK_HEADER_SIZE + next->size;
+    chunk->next = next->next;
+    if (next->next != NULL) {
+        next->next->prev = chunk;
     } else {
-        assert(tail_page->tail_chunk == NULL);
-        tail_page->tail_chunk = chunk;
+        chunk->page->tail_chunk = chunk;
     }
 }
 
+static void* allocate(size_t size) {
+    size = ALIGN_UP(size);
+
+    struct chunk_metadata* chunk = find_free_chunk_of_size(size);
+    if (chunk == NULL) {
+        chunk = get_new_page(size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+    }
+
+    unlink_free(chunk);
+    split_chunk(chunk, size);
+    return get_chunk_data(chunk);
+}
+
+static void deallocate(void* ptr) {
+    struct chunk_metadata* chunk = get_chunk_of_data(ptr);
+
+    if (chunk->next != NULL && chunk->next->is_free) {
+        absorb_next(chunk);
+    }
+    // A free chunk before this one is already on the free list, so this one just joins it
+    if (chunk->prev != NULL && chunk->prev->is_free) {
+        struct chunk_metadata* prev = chunk->prev;
+        prev->size += CHUNK_HEADER_SIZE + chunk->size;
+        prev->next = chunk->next;
+        if (chunk->next != NULL) {
+            chunk->next->prev = prev;
+        } else {
+            prev->page->tail_chunk = prev;
+        }
+        chunk = prev;
+    } else {
+        push_free(chunk);
+    }
+
+    // A page that's all free again goes back to the system, unless it's the only one
+    struct page_metadata* page = chunk->page;
+    if (chunk->prev == NULL && chunk->next == NULL && head_page != tail_page) {
+        release_page(page);
+    }
+}
+
+// A sampled allocation goes to the guard pool when it has room, everything else through the lock
+static void* allocate_sampled(size_t size, const void* caller, struct alloc_trace_stamp* traced_at) {
+    if (guard_should_sample()) {
+        void* ptr = guard_allocate(size, caller, traced_at);
+        if (ptr != NULL) {
+            return ptr;
+        }
+    }
+
+    pthread_mutex_lock(&lock);
+    void* ptr = allocate(size);
+    *traced_at = alloc_trace_timestamp();
+    pthread_mutex_unlock(&lock);
+    return ptr;
+}
+
 void* my_malloc(size_t size) {
-    if (size < 0)
+    if (size == 0) {
         return NULL;
+    }
+
+    struct alloc_trace_stamp traced_at;
+    void* ptr = allocate_sampled(size, __builtin_return_address(0), &traced_at);
 
-    struct free_space_entry* free_space_entry = find_free_space_of_size(size);
-    if (free_space_entry == NULL) {
-        free_space_entry = get_free_space_with_new_page(size);
+    if (traced_at.timestamp_ns != 0 && ptr != NULL) {
+        alloc_trace_record(ALLOC_TRACE_MALLOC, ptr, NULL, size, traced_at, __builtin_return_address(0));
+    }
+    return ptr;
+}
+
+// Needs the lock
+static void* reallocate(void* ptr, size_t size) {
+    struct chunk_metadata* chunk = get_chunk_of_data(ptr);
+    const size_t aligned_size = ALIGN_UP(size);
+
+    // Grow in place when the next chunk is free and big enough
+    if (chunk->size < aligned_size && chunk->next != NULL && chunk->next->is_free
+        && chunk->size + CHUNK_HEADER_SIZE + chunk->next->size >= aligned_size) {
+        absorb_next(chunk);
+    }
+
+    if (chunk->size >= aligned_size) {
+        split_chunk(chunk, aligned_size);
+        return ptr;
+    }
+
+    const size_t old_size = chunk->size;
+    void* moved = allocate(aligned_size);
+    if (moved != NULL) {
+        memcpy(moved, ptr, old_size);
+        deallocate(ptr);
+    }
+    return moved;
+}
+
+// Shared by freedom and my_realloc, caller is whoever called those
+static void free_and_trace(void* ptr, const void* caller) {
+    struct alloc_trace_stamp traced_at;
+    if (guard_owns(ptr)) {
+        guard_free(ptr, caller, &traced_at);
+    } else {
+        pthread_mutex_lock(&lock);
+        deallocate(ptr);
+        traced_at = alloc_trace_timestamp();
+        pthread_mutex_unlock(&lock);
+    }
+
+    if (traced_at.timestamp_ns != 0) {
+        alloc_trace_record(ALLOC_TRACE_FREE, ptr, NULL, 0, traced_at, caller);
     }
 }
 
 void* my_realloc(void* ptr, size_t size) {
+    const void* caller = __builtin_return_address(0);
+    if (size == 0) {
+        if (ptr != NULL) {
+            free_and_trace(ptr, caller);
+        }
+        return NULL;
+    }
+
+    struct alloc_trace_stamp traced_at;
+    void* new_ptr;
+    if (ptr == NULL) {
+        new_ptr = allocate_sampled(size, caller, &traced_at);
+    } else if (guard_owns(ptr)) {
+        // A guarded allocation can't grow in its page, so it moves, maybe into another slot
+        const size_t old_size = guard_size(ptr);
+        new_ptr = allocate_sampled(size, caller, &traced_at);
+        if (new_ptr != NULL) {
+            memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+            struct alloc_trace_stamp freed_at;
+            guard_free(ptr, caller, &freed_at);
+        }
+    } else {
+        pthread_mutex_lock(&lock);
+        new_ptr = reallocate(ptr, size);
+        traced_at = alloc_trace_timestamp();
+        pthread_mutex_unlock(&lock);
+    }
 
+    if (traced_at.timestamp_ns != 0 && new_ptr != NULL) {
+        alloc_trace_record(ALLOC_TRACE_REALLOC, new_ptr, ptr, size, traced_at, caller);
+    }
+    return new_ptr;
 }
 
 void freedom(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
 
-}
\ No newline at end of file
+    free_and_trace(ptr, __builtin_return_address(0));
+}
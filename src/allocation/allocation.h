@@ -1,6 +1,22 @@
 #pragma once
+#include <stdbool.h>
 #include <stddef.h>
 
 void* my_malloc(size_t size);
 void* my_realloc(void* ptr, size_t size);
-void freedom(void* ptr);
\ No newline at end of file
+void freedom(void* ptr);
+
+// Records every my_malloc/my_realloc/freedom call (size, call site, timestamp) into path, for trace_report.c.
+// Setting CSTUFF_ALLOC_TRACE=<path> does the same from startup until exit. Returns false if it can't
+// open path or a trace is already running
+bool my_malloc_trace_start(const char* path);
+// Flushes every thread's records and closes the file
+void my_malloc_trace_stop();
+
+// Sampled guard pages: 1 in sample_rate allocations of up to a page get a page of their own between
+// PROT_NONE guard pages, and the page is protected again once freed, so an overflow or a use after free
+// crashes right there with a report instead of corrupting something. The pool of slot_count pages
+// (0 for the default) is mapped on the first call and kept, sample_rate 0 turns sampling off again.
+// CSTUFF_ALLOC_GUARD_RATE and CSTUFF_ALLOC_GUARD_SLOTS do the same at startup
+bool my_malloc_guard_enable(unsigned int sample_rate, int slot_count);
+bool my_malloc_is_guarded(const void* ptr);
@@ -0,0 +1,362 @@
+// NOLINTNEXTLINE
+#define _GNU_SOURCE
+#include "allocation_guard.h"
+#include "allocation.h"
+#include "allocation_trace.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// The pool is one mapping of alternating guard pages and slot pages, guard first and last:
+//   [guard][slot 0][guard][slot 1][guard] ... [slot n-1][guard]
+// A sampled allocation gets a slot page to itself, pushed up against the guard after it so running
+// off the end faults straight away. The rest of the page is filled with a pattern that's checked on
+// free, which catches the few bytes of alignment padding the guard page can't. Freed slots go back to
+// PROT_NONE, so a use after free faults too, and they're reused oldest first to keep that window long.
+// Everything here is under guard_lock, only the fault handler reads the slots without it.
+
+#define GUARD_ALIGNMENT 16
+#define GUARD_ALIGN_UP(value) (((value) + GUARD_ALIGNMENT - 1) & ~(size_t) (GUARD_ALIGNMENT - 1))
+#define GUARD_DEFAULT_SLOTS 64
+#define GUARD_PATTERN 0xab
+#define GUARD_RATE_ENV_VAR "CSTUFF_ALLOC_GUARD_RATE"
+#define GUARD_SLOTS_ENV_VAR "CSTUFF_ALLOC_GUARD_SLOTS"
+
+enum guard_slot_state {
+    GUARD_SLOT_UNUSED,
+    GUARD_SLOT_ALLOCATED,
+    GUARD_SLOT_FREED,
+};
+
+struct guard_slot {
+    enum guard_slot_state state;
+    void* ptr;
+    size_t size;
+    const void* allocated_from;
+    const void* freed_from;
+};
+
+atomic_uint guard_sample_rate = 0;
+atomic_uintptr_t guard_pool_start = 0;
+atomic_uintptr_t guard_pool_end = 0;
+_Thread_local unsigned int guard_countdown = 0;
+
+static _Thread_local unsigned int random_state = 0;
+
+static pthread_mutex_t guard_lock = PTHREAD_MUTEX_INITIALIZER;
+static char* pool = NULL;
+static size_t page_size;
+static int slot_count;
+static struct guard_slot* slots;
+// Free slots, oldest freed at free_head
+static int* free_queue;
+static int free_head;
+static int free_count;
+static struct sigaction previous_segv_action;
+
+unsigned int guard_next_interval(unsigned int rate) {
+    if (rate <= 1) {
+        return 1;
+    }
+
+    if (random_state == 0) {
+        random_state = (unsigned int) (uintptr_t) &random_state ^ (unsigned int) time(NULL) ^ 0x9E3779B9u;
+    }
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return 1 + random_state % (2 * rate - 1);
+}
+
+static char* get_slot_page(int slot) {
+    return pool + page_size * (2 * (size_t) slot + 1);
+}
+
+// Which slot page holds address, or -1 for a guard page (the slots either side are then slot - 1 and slot)
+static int get_slot_of_page(const void* address, int* guard_index) {
+    const size_t page = (size_t) ((const char*) address - pool) / page_size;
+    *guard_index = (int) (page / 2);
+    return page % 2 == 1 ? (int) (page / 2) : -1;
+}
+
+// Reports are built by hand and go out with write, the fault handler can't use stdio or snprintf
+struct guard_report {
+    char text[256];
+    size_t length;
+};
+
+static void append_text(struct guard_report* report, const char* text) {
+    while (*text != '\0' && report->length < sizeof(report->text)) {
+        report->text[report->length++] = *text++;
+    }
+}
+
+static void append_number(struct guard_report* report, uintptr_t value, unsigned int base) {
+    char digits[3 * sizeof(uintptr_t)]; // enough for base 10
+    int count = 0;
+    do {
+        digits[count++] = "0123456789abcdef"[value % base];
+        value /= base;
+    } while (value != 0);
+
+    if (base == 16) {
+        append_text(report, "0x");
+    }
+    while (count > 0 && report->length < sizeof(report->text)) {
+        report->text[report->length++] = digits[--count];
+    }
+}
+
+static void write_report(const struct guard_report* report) {
+    const ssize_t ignored = write(STDERR_FILENO, report->text, report->length);
+    (void) ignored;
+}
+
+static void report_slot(const char* problem, const struct guard_slot* slot, const void* address) {
+    struct guard_report report = {.length = 0};
+    append_text(&report, "allocation: ");
+    append_text(&report, problem);
+    append_text(&report, " at ");
+    append_number(&report, (uintptr_t) address, 16);
+    append_text(&report, ", ");
+    append_number(&report, slot->size, 10);
+    append_text(&report, " byte allocation at ");
+    append_number(&report, (uintptr_t) slot->ptr, 16);
+    append_text(&report, " allocated from ");
+    append_number(&report, (uintptr_t) slot->allocated_from, 16);
+    if (slot->state == GUARD_SLOT_FREED) {
+        append_text(&report, " freed from ");
+        append_number(&report, (uintptr_t) slot->freed_from, 16);
+    }
+    append_text(&report, "\n");
+    write_report(&report);
+}
+
+static void report_unknown_pointer(const char* call, const void* ptr) {
+    struct guard_report report = {.length = 0};
+    append_text(&report, "allocation: ");
+    append_text(&report, call);
+    append_text(&report, " of ");
+    append_number(&report, (uintptr_t) ptr, 16);
+    append_text(&report, ", which my_malloc never returned\n");
+    write_report(&report);
+}
+
+static void handle_segv(int signal, siginfo_t* info, void* context) {
+    (void) signal;
+    (void) context;
+    const char* address = info->si_addr;
+
+    if (pool == NULL || address < pool || address >= pool + page_size * (2 * (size_t) slot_count + 1)) {
+        // Not ours, let whoever was handling faults before have it when the access is retried
+        sigaction(SIGSEGV, &previous_segv_action, NULL);
+        return;
+    }
+
+    int guard_index;
+    const int slot_index = get_slot_of_page(address, &guard_index);
+    if (slot_index != -1) {
+        const struct guard_slot* slot = &slots[slot_index];
+        report_slot(slot->state == GUARD_SLOT_FREED ? "use after free" : "access to an unused guard slot", slot,
+                    address);
+    } else {
+        // Allocations sit at the end of their page, so the guard after a slot is where overflows land
+        const struct guard_slot* before = guard_index > 0 ? &slots[guard_index - 1] : NULL;
+        const struct guard_slot* after = guard_index < slot_count ? &slots[guard_index] : NULL;
+        if (before != NULL && before->state != GUARD_SLOT_UNUSED) {
+            report_slot("buffer overflow", before, address);
+        } else if (after != NULL && after->state != GUARD_SLOT_UNUSED) {
+            report_slot("buffer underflow", after, address);
+        } else {
+            struct guard_report report = {.length = 0};
+            append_text(&report, "allocation: access to a guard page with no allocation next to it\n");
+            write_report(&report);
+        }
+    }
+
+    // Crash on the retried access like there was no handler, so it still dumps core where it happened
+    struct sigaction default_action;
+    memset(&default_action, 0, sizeof(default_action));
+    default_action.sa_handler = SIG_DFL;
+    sigaction(SIGSEGV, &default_action, NULL);
+}
+
+// Needs guard_lock
+static bool map_pool(int count) {
+    page_size = (size_t) getpagesize();
+    const size_t pool_size = page_size * (2 * (size_t) count + 1);
+
+    void* address = mmap(NULL, pool_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    // Bookkeeping comes from libc, not my_malloc, it's needed before my_malloc is safe to call here
+    slots = calloc(count, sizeof(struct guard_slot));
+    free_queue = malloc(sizeof(int) * count);
+    if (slots == NULL || free_queue == NULL) {
+        free(slots);
+        free(free_queue);
+        munmap(address, pool_size);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        free_queue[i] = i;
+    }
+    free_head = 0;
+    free_count = count;
+    slot_count = count;
+    pool = address;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = handle_segv;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, &previous_segv_action);
+
+    atomic_store(&guard_pool_start, (uintptr_t) pool);
+    atomic_store(&guard_pool_end, (uintptr_t) pool + pool_size);
+    return true;
+}
+
+bool my_malloc_guard_enable(unsigned int sample_rate, int slots_to_map) {
+    pthread_mutex_lock(&guard_lock);
+    if (sample_rate != 0 && pool == NULL && !map_pool(slots_to_map > 0 ? slots_to_map : GUARD_DEFAULT_SLOTS)) {
+        pthread_mutex_unlock(&guard_lock);
+        return false;
+    }
+
+    atomic_store(&guard_sample_rate, sample_rate);
+    guard_countdown = 0; // other threads pick the new rate up after their current countdown
+    pthread_mutex_unlock(&guard_lock);
+    return true;
+}
+
+bool my_malloc_is_guarded(const void* ptr) {
+    return ptr != NULL && guard_owns(ptr);
+}
+
+void* guard_allocate(size_t size, const void* caller, struct alloc_trace_stamp* traced_at) {
+    if (GUARD_ALIGN_UP(size) > page_size) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&guard_lock);
+    if (free_count == 0) {
+        pthread_mutex_unlock(&guard_lock);
+        return NULL;
+    }
+
+    const int slot_index = free_queue[free_head];
+    free_head = (free_head + 1) % slot_count;
+    free_count--;
+
+    char* page = get_slot_page(slot_index);
+    if (mprotect(page, page_size, PROT_READ | PROT_WRITE) != 0) {
+        free_queue[(free_head + free_count) % slot_count] = slot_index;
+        free_count++;
+        pthread_mutex_unlock(&guard_lock);
+        return NULL;
+    }
+    memset(page, GUARD_PATTERN, page_size);
+
+    struct guard_slot* slot = &slots[slot_index];
+    slot->ptr = page + page_size - GUARD_ALIGN_UP(size);
+    slot->size = size;
+    slot->allocated_from = caller;
+    slot->freed_from = NULL;
+    slot->state = GUARD_SLOT_ALLOCATED;
+
+    *traced_at = alloc_trace_timestamp();
+    pthread_mutex_unlock(&guard_lock);
+    return slot->ptr;
+}
+
+static bool is_pattern(const char* bytes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if ((unsigned char) bytes[i] != GUARD_PATTERN) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void guard_free(void* ptr, const void* caller, struct alloc_trace_stamp* traced_at) {
+    pthread_mutex_lock(&guard_lock);
+
+    int guard_index;
+    const int slot_index = get_slot_of_page(ptr, &guard_index);
+    struct guard_slot* slot = slot_index != -1 ? &slots[slot_index] : NULL;
+
+    if (slot == NULL || slot->ptr != ptr || slot->state != GUARD_SLOT_ALLOCATED) {
+        if (slot != NULL && slot->ptr == ptr && slot->state == GUARD_SLOT_FREED) {
+            report_slot("double free", slot, ptr);
+        } else {
+            report_unknown_pointer("free", ptr);
+        }
+        abort();
+    }
+
+    // Writes that stayed inside the page, just before the allocation or into its alignment padding
+    const char* page = get_slot_page(slot_index);
+    const char* end = (const char*) ptr + slot->size;
+    if (!is_pattern(page, (const char*) ptr - page)) {
+        report_slot("buffer underflow found on free", slot, ptr);
+        abort();
+    }
+    if (!is_pattern(end, page + page_size - end)) {
+        report_slot("buffer overflow found on free", slot, end);
+        abort();
+    }
+
+    mprotect((void*) page, page_size, PROT_NONE);
+    slot->state = GUARD_SLOT_FREED;
+    slot->freed_from = caller;
+    free_queue[(free_head + free_count) % slot_count] = slot_index;
+    free_count++;
+
+    *traced_at = alloc_trace_timestamp();
+    pthread_mutex_unlock(&guard_lock);
+}
+
+size_t guard_size(const void* ptr) {
+    pthread_mutex_lock(&guard_lock);
+
+    int guard_index;
+    const int slot_index = get_slot_of_page(ptr, &guard_index);
+    const struct guard_slot* slot = slot_index != -1 ? &slots[slot_index] : NULL;
+
+    if (slot == NULL || slot->ptr != ptr || slot->state != GUARD_SLOT_ALLOCATED) {
+        if (slot != NULL && slot->ptr == ptr && slot->state == GUARD_SLOT_FREED) {
+            report_slot("realloc after free", slot, ptr);
+        } else {
+            report_unknown_pointer("realloc", ptr);
+        }
+        abort();
+    }
+
+    const size_t size = slot->size;
+    pthread_mutex_unlock(&guard_lock);
+    return size;
+}
+
+__attribute__((constructor)) static void enable_guard_from_environment() {
+    const char* rate = getenv(GUARD_RATE_ENV_VAR);
+    if (rate == NULL || rate[0] == '\0') {
+        return;
+    }
+
+    const char* slots_value = getenv(GUARD_SLOTS_ENV_VAR);
+    const int slots_to_map = slots_value != NULL ? atoi(slots_value) : 0;
+    if (!my_malloc_guard_enable((unsigned int) strtoul(rate, NULL, 10), slots_to_map)) {
+        fprintf(stderr, "allocation: couldn't map the guard page pool for %s=%s\n", GUARD_RATE_ENV_VAR, rate);
+    }
+}
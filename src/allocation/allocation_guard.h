@@ -0,0 +1,48 @@
+#pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct alloc_trace_stamp;
+
+// Sampled guard page mode, see allocation_guard.c. allocation.c asks guard_should_sample on every
+// my_malloc and guard_owns on every free, both stay a load and a compare or two while it's off
+
+extern atomic_uint guard_sample_rate; // 0 while off
+extern atomic_uintptr_t guard_pool_start; // 0 until the slot pool is mapped
+extern atomic_uintptr_t guard_pool_end;
+extern _Thread_local unsigned int guard_countdown; // allocations left before this thread samples one
+
+// Random gap to the next sample, averaging rate so allocation patterns can't line up with it
+unsigned int guard_next_interval(unsigned int rate);
+
+static inline bool guard_should_sample() {
+    const unsigned int rate = atomic_load_explicit(&guard_sample_rate, memory_order_relaxed);
+    if (rate == 0) {
+        return false;
+    }
+
+    if (guard_countdown == 0) {
+        guard_countdown = guard_next_interval(rate);
+    }
+    if (--guard_countdown != 0) {
+        return false;
+    }
+    guard_countdown = guard_next_interval(rate);
+    return true;
+}
+
+static inline bool guard_owns(const void* ptr) {
+    const uintptr_t address = (uintptr_t) ptr;
+    return address >= atomic_load_explicit(&guard_pool_start, memory_order_relaxed)
+           && address < atomic_load_explicit(&guard_pool_end, memory_order_relaxed);
+}
+
+// NULL when size doesn't fit in a page or every slot is taken, the caller falls back to the normal path.
+// traced_at is set the same way allocation.c sets it under its own lock
+void* guard_allocate(size_t size, const void* caller, struct alloc_trace_stamp* traced_at);
+// Aborts with a report on a double or invalid free, or if the bytes around the allocation were written to
+void guard_free(void* ptr, const void* caller, struct alloc_trace_stamp* traced_at);
+// The size that was asked for. Aborts with a report when ptr isn't a live allocation from the pool
+size_t guard_size(const void* ptr);
@@ -1,5 +1,6 @@
 #pragma once
 #include <stdbool.h>
+#include <stddef.h>
 
 #define MAX_PAGES 10
 
@@ -35,6 +36,8 @@ struct page_type_list {
 struct page_metadata {
     size_t size;
     const struct page_type_entry* page_type;
+    struct page_metadata* prev;
+    struct page_metadata* next;
     struct chunk_metadata* head_chunk;
     struct chunk_metadata* tail_chunk;
 };
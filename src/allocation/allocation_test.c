@@ -0,0 +1,227 @@
+// ReSharper disable CppLocalVariableMayBeConst
+#pragma once
+#include "allocation.h"
+#include "allocation_trace.h"
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+// Runs action in a child process and returns the signal it died of, 0 if it exited normally
+static int signalOfChild(void (*action)(char*), char* ptr) {
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        // The reports are expected here, keep them out of the test output
+        freopen("/dev/null", "w", stderr);
+        action(ptr);
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+static void writePastEnd(char* ptr) {
+    ptr[48] = 'x';
+}
+
+static void writeIntoPadding(char* ptr) {
+    ptr[40] = 'x';
+    freedom(ptr);
+}
+
+static void readByte(char* ptr) {
+    *(volatile char*) ptr;
+}
+
+static void readAfterFree(char* ptr) {
+    freedom(ptr);
+    readByte(ptr);
+}
+
+static void freeTwice(char* ptr) {
+    freedom(ptr);
+    freedom(ptr);
+}
+
+static void reallocAfterFree(char* ptr) {
+    freedom(ptr);
+    my_realloc(ptr, 100);
+}
+
+static void reallocGuardPage(char* ptr) {
+    my_realloc(ptr + 48, 100);
+}
+
+static void writeInBounds(char* ptr) {
+    memset(ptr, 'y', 40);
+    freedom(ptr);
+}
+
+void testAllocation() {
+    printf("=== Allocation Test ===\n\n");
+
+    // Test 1: Basic allocations
+    printf("Test 1: Allocating and freeing\n");
+    assert(my_malloc(0) == NULL);
+    freedom(NULL);
+
+    char* small = my_malloc(25);
+    assert(small != NULL);
+    assert((uintptr_t) small % 16 == 0);
+    memset(small, 'a', 25);
+
+    char* other = my_malloc(100);
+    assert(other != NULL && other != small);
+    assert(other >= small + 25 || other + 100 <= small);
+    memset(other, 'b', 100);
+    assert(small[24] == 'a');
+
+    // Freed space gets handed out again
+    freedom(small);
+    char* reused = my_malloc(16);
+    assert(reused == small);
+    freedom(reused);
+    freedom(other);
+    printf("✓ Allocating and freeing working correctly\n\n");
+
+    // Test 2: Realloc keeps the contents
+    printf("Test 2: Reallocating\n");
+    int* numbers = my_realloc(NULL, sizeof(int) * 4);
+    for (int i = 0; i < 4; i++) {
+        numbers[i] = i;
+    }
+    for (int size = 8; size <= 1 << 20; size *= 2) {
+        numbers = my_realloc(numbers, sizeof(int) * size);
+        for (int i = size / 2; i < size; i++) {
+            numbers[i] = i;
+        }
+    }
+    for (int i = 0; i < 1 << 20; i++) {
+        assert(numbers[i] == i);
+    }
+    numbers = my_realloc(numbers, sizeof(int) * 10);
+    assert(numbers[9] == 9);
+    assert(my_realloc(numbers, 0) == NULL);
+    printf("✓ Reallocating working correctly\n\n");
+
+    // Test 3: Random sizes, every block keeps its own contents
+    printf("Test 3: Random allocations\n");
+    void* blocks[500] = {NULL};
+    size_t sizes[500] = {0};
+    srand(50);
+    for (int step = 0; step < 20000; step++) {
+        const int i = rand() % 500;
+        if (blocks[i] != NULL) {
+            const unsigned char* bytes = blocks[i];
+            for (size_t j = 0; j < sizes[i]; j++) {
+                assert(bytes[j] == (unsigned char) i);
+            }
+            freedom(blocks[i]);
+            blocks[i] = NULL;
+        } else {
+            sizes[i] = rand() % 10 == 0 ? 1 + rand() % 100000 : 1 + rand() % 300;
+            blocks[i] = my_malloc(sizes[i]);
+            assert(blocks[i] != NULL);
+            memset(blocks[i], i, sizes[i]);
+        }
+    }
+    for (int i = 0; i < 500; i++) {
+        freedom(blocks[i]);
+    }
+    printf("✓ Random allocations working correctly\n\n");
+
+    // Test 4: Tracing writes one record per call, in order, with the caller's address
+    printf("Test 4: Tracing\n");
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/allocation_trace_%i.bin", (int) getpid());
+    assert(my_malloc_trace_start(path));
+    assert(!my_malloc_trace_start(path));
+
+    void* traced = my_malloc(40);
+    traced = my_realloc(traced, 4000);
+    freedom(traced);
+    my_malloc_trace_stop();
+    freedom(my_malloc(8)); // not traced any more
+
+    FILE* trace = fopen(path, "rb");
+    assert(trace != NULL);
+    struct alloc_trace_header header;
+    assert(fread(&header, sizeof(header), 1, trace) == 1);
+    assert(memcmp(header.magic, ALLOC_TRACE_MAGIC, 8) == 0);
+    assert(header.record_size == sizeof(struct alloc_trace_record));
+
+    struct alloc_trace_record records[4];
+    assert(fread(records, sizeof(struct alloc_trace_record), 4, trace) == 3);
+    fclose(trace);
+    unlink(path);
+
+    assert(records[0].kind == ALLOC_TRACE_MALLOC && records[0].size == 40);
+    assert(records[1].kind == ALLOC_TRACE_REALLOC && records[1].size == 4000);
+    assert(records[1].old_address == records[0].address);
+    assert(records[2].kind == ALLOC_TRACE_FREE && records[2].address == records[1].address);
+    // All three calls come from right here, so their call sites are a few instructions apart
+    for (int i = 0; i < 3; i++) {
+        assert(records[i].call_sites[0] != 0);
+        assert(records[i].call_sites[0] - records[0].call_sites[0] < 4096);
+        assert(i == 0 || records[i].timestamp_ns >= records[i - 1].timestamp_ns);
+        assert(i == 0 || records[i].sequence > records[i - 1].sequence);
+    }
+    printf("✓ Tracing working correctly\n\n");
+
+    // Test 5: Guard pages, every allocation is sampled while the rate is 1
+    printf("Test 5: Guard pages\n");
+    assert(my_malloc_guard_enable(1, 8));
+
+    char* guarded = my_malloc(40);
+    assert(my_malloc_is_guarded(guarded));
+    assert((uintptr_t) guarded % 16 == 0);
+    assert(((uintptr_t) guarded + 48) % (uintptr_t) sysconf(_SC_PAGESIZE) == 0); // right up against the guard page
+    memcpy(guarded, "guarded", 8);
+
+    assert(signalOfChild(writeInBounds, guarded) == 0);
+    assert(signalOfChild(writePastEnd, guarded) == SIGSEGV);
+    assert(signalOfChild(writeIntoPadding, guarded) == SIGABRT);
+    assert(signalOfChild(readAfterFree, guarded) == SIGSEGV);
+    assert(signalOfChild(freeTwice, guarded) == SIGABRT);
+    assert(signalOfChild(reallocAfterFree, guarded) == SIGABRT);
+    assert(signalOfChild(reallocGuardPage, guarded) == SIGABRT);
+
+    // Moves to another slot, keeping the contents
+    char* moved_guarded = my_realloc(guarded, 100);
+    assert(moved_guarded != guarded && my_malloc_is_guarded(moved_guarded));
+    assert(strcmp(moved_guarded, "guarded") == 0);
+    assert(signalOfChild(readByte, guarded) == SIGSEGV); // the old slot is protected again
+    freedom(moved_guarded);
+
+    // Too big for a page, or no slots left, falls back to the normal path
+    char* big = my_malloc((size_t) sysconf(_SC_PAGESIZE) * 2);
+    assert(big != NULL && !my_malloc_is_guarded(big));
+    freedom(big);
+
+    void* taken[12];
+    int guarded_count = 0;
+    for (int i = 0; i < 12; i++) {
+        taken[i] = my_malloc(16);
+        assert(taken[i] != NULL);
+        guarded_count += my_malloc_is_guarded(taken[i]);
+    }
+    assert(guarded_count == 8);
+
+    assert(my_malloc_guard_enable(0, 0));
+    char* unsampled = my_malloc(16);
+    assert(!my_malloc_is_guarded(unsampled));
+    freedom(unsampled);
+    for (int i = 0; i < 12; i++) {
+        freedom(taken[i]);
+    }
+    printf("✓ Guard pages working correctly\n\n");
+
+    printf("✓ All allocation tests passed!\n");
+}
@@ -0,0 +1,256 @@
+// NOLINTNEXTLINE
+#define _GNU_SOURCE
+#include "allocation_trace.h"
+#include "allocation.h"
+
+#include <execinfo.h>
+#include <fcntl.h>
+#include <link.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Every thread records into its own ring buffer without taking a lock. The owning thread is the only
+// producer, the consumer is whoever holds file_lock: the owner when its buffer is full or the thread
+// exits, or my_malloc_trace_stop. Buffers are mmap'd so tracing never allocates through my_malloc itself.
+
+#define TRACE_BUFFER_RECORDS 4096 // must be a power of two
+#define TRACE_ENV_VAR "CSTUFF_ALLOC_TRACE"
+
+struct trace_buffer {
+    struct trace_buffer* next; // buffers are never unmapped, threads that exit hand theirs on
+    atomic_bool in_use;
+    uint32_t thread_id;
+    alignas(64) atomic_ullong head; // next record the owner writes
+    alignas(64) atomic_ullong tail; // next record to go to the file
+    struct alloc_trace_record records[TRACE_BUFFER_RECORDS];
+};
+
+atomic_bool alloc_trace_enabled = false;
+
+static atomic_ullong next_sequence = 0;
+static pthread_mutex_t file_lock = PTHREAD_MUTEX_INITIALIZER;
+static int trace_fd = -1;
+static _Atomic(struct trace_buffer*) buffers = NULL;
+static _Thread_local struct trace_buffer* thread_buffer = NULL;
+static pthread_key_t thread_exit_key;
+static pthread_once_t thread_exit_key_once = PTHREAD_ONCE_INIT;
+
+struct alloc_trace_stamp alloc_trace_clock() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (struct alloc_trace_stamp) {
+        .timestamp_ns = (uint64_t) time.tv_sec * 1000000000ull + (uint64_t) time.tv_nsec,
+        .sequence = atomic_fetch_add_explicit(&next_sequence, 1, memory_order_relaxed),
+    };
+}
+
+static bool write_all(int fd, const void* data, size_t size) {
+    const char* bytes = data;
+    while (size > 0) {
+        const ssize_t written = write(fd, bytes, size);
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= (size_t) written;
+    }
+    return true;
+}
+
+// Moves everything recorded so far into the file, or drops it when tracing was stopped. Needs file_lock
+static void drain_buffer(struct trace_buffer* buffer) {
+    const unsigned long long head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+    unsigned long long tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+
+    while (tail < head && trace_fd != -1) {
+        const unsigned long long start = tail & (TRACE_BUFFER_RECORDS - 1);
+        unsigned long long count = head - tail;
+        if (count > TRACE_BUFFER_RECORDS - start) {
+            count = TRACE_BUFFER_RECORDS - start;
+        }
+
+        if (!write_all(trace_fd, &buffer->records[start], sizeof(struct alloc_trace_record) * count)) {
+            fprintf(stderr, "allocation: failed to write the trace, tracing stopped\n");
+            atomic_store(&alloc_trace_enabled, false);
+            close(trace_fd);
+            trace_fd = -1;
+            break;
+        }
+        tail += count;
+    }
+
+    atomic_store_explicit(&buffer->tail, head, memory_order_release);
+}
+
+static void release_thread_buffer(void* value) {
+    struct trace_buffer* buffer = value;
+
+    pthread_mutex_lock(&file_lock);
+    drain_buffer(buffer);
+    pthread_mutex_unlock(&file_lock);
+
+    // Anything this thread frees after here claims a buffer again
+    thread_buffer = NULL;
+    atomic_store_explicit(&buffer->in_use, false, memory_order_release);
+}
+
+static void create_thread_exit_key() {
+    pthread_key_create(&thread_exit_key, release_thread_buffer);
+}
+
+static struct trace_buffer* claim_thread_buffer() {
+    struct trace_buffer* buffer = atomic_load_explicit(&buffers, memory_order_acquire);
+    for (; buffer != NULL; buffer = buffer->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&buffer->in_use, &expected, true)) {
+            break;
+        }
+    }
+
+    if (buffer == NULL) {
+        void* address = mmap(NULL, sizeof(struct trace_buffer), PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED) {
+            return NULL;
+        }
+
+        buffer = address;
+        atomic_init(&buffer->in_use, true);
+        atomic_init(&buffer->head, 0);
+        atomic_init(&buffer->tail, 0);
+
+        buffer->next = atomic_load_explicit(&buffers, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&buffers, &buffer->next, buffer,
+                                                      memory_order_release, memory_order_relaxed)) {
+        }
+    }
+
+    buffer->thread_id = (uint32_t) syscall(SYS_gettid);
+    pthread_once(&thread_exit_key_once, create_thread_exit_key);
+    pthread_setspecific(thread_exit_key, buffer);
+    thread_buffer = buffer;
+    return buffer;
+}
+
+// Frames the backtrace can go through before reaching caller: this function, and my_malloc if it wasn't tail called
+#define TRACE_SKIPPED_FRAMES 2
+
+void alloc_trace_record(enum alloc_trace_kind kind, const void* address, const void* old_address, size_t size,
+                        struct alloc_trace_stamp traced_at, const void* caller) {
+    void* frames[ALLOC_TRACE_FRAMES + TRACE_SKIPPED_FRAMES];
+    const int depth = backtrace(frames, ALLOC_TRACE_FRAMES + TRACE_SKIPPED_FRAMES);
+
+    int first = 0;
+    while (first < depth && frames[first] != caller) {
+        first++;
+    }
+
+    struct trace_buffer* buffer = thread_buffer != NULL ? thread_buffer : claim_thread_buffer();
+    if (buffer == NULL) {
+        return;
+    }
+
+    const unsigned long long head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&buffer->tail, memory_order_acquire) == TRACE_BUFFER_RECORDS) {
+        pthread_mutex_lock(&file_lock);
+        drain_buffer(buffer);
+        pthread_mutex_unlock(&file_lock);
+    }
+
+    struct alloc_trace_record* record = &buffer->records[head & (TRACE_BUFFER_RECORDS - 1)];
+    record->timestamp_ns = traced_at.timestamp_ns;
+    record->sequence = traced_at.sequence;
+    record->address = (uint64_t) (uintptr_t) address;
+    record->old_address = (uint64_t) (uintptr_t) old_address;
+    record->size = size;
+    record->call_sites[0] = (uint64_t) (uintptr_t) caller;
+    for (int i = 1; i < ALLOC_TRACE_FRAMES; i++) {
+        record->call_sites[i] = first + i < depth ? (uint64_t) (uintptr_t) frames[first + i] : 0;
+    }
+    record->thread_id = buffer->thread_id;
+    record->kind = kind;
+
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+// The executable is always the first object reported
+static int find_load_base(struct dl_phdr_info* info, size_t size, void* data) {
+    (void) size;
+    *(uint64_t*) data = info->dlpi_addr;
+    return 1;
+}
+
+bool my_malloc_trace_start(const char* path) {
+    pthread_mutex_lock(&file_lock);
+    if (trace_fd != -1) {
+        pthread_mutex_unlock(&file_lock);
+        return false;
+    }
+
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        pthread_mutex_unlock(&file_lock);
+        return false;
+    }
+
+    struct alloc_trace_header header = {0};
+    memcpy(header.magic, ALLOC_TRACE_MAGIC, sizeof(header.magic));
+    header.version = ALLOC_TRACE_VERSION;
+    header.record_size = sizeof(struct alloc_trace_record);
+    dl_iterate_phdr(find_load_base, &header.load_base);
+
+    if (!write_all(fd, &header, sizeof(header))) {
+        close(fd);
+        pthread_mutex_unlock(&file_lock);
+        return false;
+    }
+
+    // Leftovers from an earlier trace that were recorded after it stopped
+    for (struct trace_buffer* buffer = atomic_load(&buffers); buffer != NULL; buffer = buffer->next) {
+        drain_buffer(buffer);
+    }
+
+    // backtrace loads the unwinder the first time, better here than in the middle of the first record
+    void* frames[1];
+    backtrace(frames, 1);
+
+    trace_fd = fd;
+    atomic_store(&alloc_trace_enabled, true);
+    pthread_mutex_unlock(&file_lock);
+    return true;
+}
+
+void my_malloc_trace_stop() {
+    pthread_mutex_lock(&file_lock);
+    atomic_store(&alloc_trace_enabled, false);
+
+    for (struct trace_buffer* buffer = atomic_load(&buffers); buffer != NULL; buffer = buffer->next) {
+        drain_buffer(buffer);
+    }
+
+    if (trace_fd != -1) {
+        close(trace_fd);
+        trace_fd = -1;
+    }
+    pthread_mutex_unlock(&file_lock);
+}
+
+__attribute__((constructor)) static void start_trace_from_environment() {
+    const char* path = getenv(TRACE_ENV_VAR);
+    if (path == NULL || path[0] == '\0') {
+        return;
+    }
+
+    if (!my_malloc_trace_start(path)) {
+        fprintf(stderr, "allocation: couldn't open %s=%s for tracing\n", TRACE_ENV_VAR, path);
+        return;
+    }
+    atexit(my_malloc_trace_stop);
+}
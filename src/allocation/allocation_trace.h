@@ -0,0 +1,67 @@
+#pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Trace file written while my_malloc tracing is on, read back by trace_report.c.
+// One header, then fixed size records. Each thread writes its records in order, but
+// records from different threads are interleaved in blocks, so sort by timestamp and then
+// sequence before replaying.
+
+#define ALLOC_TRACE_MAGIC "CSTRACE1"
+#define ALLOC_TRACE_VERSION 2
+// Return addresses kept per record, the innermost one is the direct caller of my_malloc/my_realloc/freedom
+#define ALLOC_TRACE_FRAMES 4
+
+enum alloc_trace_kind {
+    ALLOC_TRACE_MALLOC,
+    ALLOC_TRACE_REALLOC, // old_address is 0 when it was realloc(NULL, size)
+    ALLOC_TRACE_FREE, // size is 0, the report takes it from the matching allocation
+};
+
+struct alloc_trace_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t load_base; // where the executable was mapped, call sites minus this are what addr2line wants
+};
+
+struct alloc_trace_record {
+    uint64_t timestamp_ns; // CLOCK_MONOTONIC
+    uint64_t sequence; // order the calls took the allocator's locks in, for calls with equal timestamps
+    uint64_t address;
+    uint64_t old_address;
+    uint64_t size;
+    uint64_t call_sites[ALLOC_TRACE_FRAMES]; // 0 past the end of the stack
+    uint32_t thread_id;
+    uint32_t kind;
+};
+
+extern atomic_bool alloc_trace_enabled;
+
+struct alloc_trace_stamp {
+    uint64_t timestamp_ns; // 0 while tracing is off
+    uint64_t sequence;
+};
+
+// Reads CLOCK_MONOTONIC and takes the next sequence number. Lives in allocation_trace.c, the only
+// file with the feature macros clock_gettime needs
+struct alloc_trace_stamp alloc_trace_clock();
+
+// Taken by allocation.c while it still holds its lock, so a free and the allocation that reuses the
+// address can't end up in the wrong order, even when the clock gives both the same timestamp.
+// Only the enabled check while tracing is off
+static inline struct alloc_trace_stamp alloc_trace_timestamp() {
+    if (!atomic_load_explicit(&alloc_trace_enabled, memory_order_relaxed)) {
+        return (struct alloc_trace_stamp) {0, 0};
+    }
+
+    return alloc_trace_clock();
+}
+
+// Called by allocation.c once the lock is released, for calls that got a timestamp.
+// caller is __builtin_return_address(0) of my_malloc/my_realloc/freedom, the backtrace is lined up with it
+// so it doesn't matter what got inlined or tail called in between
+void alloc_trace_record(enum alloc_trace_kind kind, const void* address, const void* old_address, size_t size,
+                        struct alloc_trace_stamp traced_at, const void* caller);
@@ -0,0 +1,187 @@
+#include "allocator.h"
+#include "allocation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_ALIGN_UP(value) (((value) + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1))
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+static void* libc_malloc(void* context, size_t size) {
+    (void) context;
+    return malloc(size);
+}
+
+static void* libc_realloc(void* context, void* ptr, size_t old_size, size_t new_size) {
+    (void) context;
+    (void) old_size;
+    return realloc(ptr, new_size);
+}
+
+static void libc_free(void* context, void* ptr, size_t size) {
+    (void) context;
+    (void) size;
+    free(ptr);
+}
+
+const struct allocator allocator_libc = {"libc", libc_malloc, libc_realloc, libc_free, NULL};
+
+static void* my_malloc_malloc(void* context, size_t size) {
+    (void) context;
+    return my_malloc(size);
+}
+
+static void* my_malloc_realloc(void* context, void* ptr, size_t old_size, size_t new_size) {
+    (void) context;
+    (void) old_size;
+    return my_realloc(ptr, new_size);
+}
+
+static void my_malloc_free(void* context, void* ptr, size_t size) {
+    (void) context;
+    (void) size;
+    freedom(ptr);
+}
+
+const struct allocator allocator_my_malloc = {"my_malloc", my_malloc_malloc, my_malloc_realloc, my_malloc_free, NULL};
+
+void* allocator_malloc(const struct allocator* allocator, size_t size) {
+    void* ptr = allocator->malloc(allocator->context, size);
+    if (ptr == NULL && size > 0) {
+        printf("failed to malloc");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+void* allocator_realloc(const struct allocator* allocator, void* ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL) {
+        return allocator_malloc(allocator, new_size);
+    }
+
+    void* new_ptr = allocator->realloc(allocator->context, ptr, old_size, new_size);
+    if (new_ptr == NULL && new_size > 0) {
+        printf("failed to realloc");
+        exit(EXIT_FAILURE);
+    }
+    return new_ptr;
+}
+
+void allocator_free(const struct allocator* allocator, void* ptr, size_t size) {
+    if (ptr != NULL) {
+        allocator->free(allocator->context, ptr, size);
+    }
+}
+
+static struct arena_block* new_arena_block(size_t size) {
+    struct arena_block* block = malloc(sizeof(struct arena_block) + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+static void* arena_malloc(void* context, size_t size) {
+    struct arena* arena = context;
+    size = ARENA_ALIGN_UP(size);
+
+    struct arena_block* block = arena->blocks;
+    if (block == NULL || block->size - block->used < size) {
+        block = new_arena_block(size > arena->block_size ? size : arena->block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+
+        // An oversized block goes behind the current one, so what's left in the current one still gets used
+        if (size > arena->block_size && arena->blocks != NULL) {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        } else {
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+    }
+
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->bytes_allocated += size;
+    return ptr;
+}
+
+static void* arena_realloc(void* context, void* ptr, size_t old_size, size_t new_size) {
+    struct arena* arena = context;
+    struct arena_block* block = arena->blocks;
+    const size_t old_aligned = ARENA_ALIGN_UP(old_size);
+    const size_t new_aligned = ARENA_ALIGN_UP(new_size);
+
+    // The most recent allocation can grow or shrink where it is
+    if (block != NULL && (unsigned char*) ptr + old_aligned == block->data + block->used
+        && block->used - old_aligned + new_aligned <= block->size) {
+        block->used = block->used - old_aligned + new_aligned;
+        arena->bytes_allocated = arena->bytes_allocated - old_aligned + new_aligned;
+        return ptr;
+    }
+
+    void* moved = arena_malloc(arena, new_size);
+    if (moved != NULL) {
+        memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    }
+    return moved;
+}
+
+static void arena_free_nothing(void* context, void* ptr, size_t size) {
+    (void) context;
+    (void) ptr;
+    (void) size;
+}
+
+struct arena* arena_new(size_t block_size) {
+    struct arena* arena = malloc(sizeof(struct arena));
+    arena->blocks = NULL;
+    arena->block_size = block_size > 0 ? ARENA_ALIGN_UP(block_size) : ARENA_DEFAULT_BLOCK_SIZE;
+    arena->bytes_allocated = 0;
+    arena->allocator = (struct allocator) {"arena", arena_malloc, arena_realloc, arena_free_nothing, arena};
+    return arena;
+}
+
+void arena_free(struct arena* arena) {
+    struct arena_block* block = arena->blocks;
+    while (block != NULL) {
+        struct arena_block* temp = block;
+        block = block->next;
+        free(temp);
+    }
+    free(arena);
+}
+
+void arena_reset(struct arena* arena) {
+    struct arena_block* kept = NULL;
+    struct arena_block* block = arena->blocks;
+
+    while (block != NULL) {
+        struct arena_block* temp = block;
+        block = block->next;
+
+        if (kept == NULL && temp->size == arena->block_size) {
+            kept = temp;
+        } else {
+            free(temp);
+        }
+    }
+
+    if (kept != NULL) {
+        kept->next = NULL;
+        kept->used = 0;
+    }
+    arena->blocks = kept;
+    arena->bytes_allocated = 0;
+}
+
+const struct allocator* arena_allocator(struct arena* arena) {
+    return &arena->allocator;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <stddef.h>
+
+// Where a container gets its memory from, passed in when the container is made.
+// Everything a container allocates goes through it, the container struct included when the container
+// allocates that itself (not for vector_init_with_allocator, where the caller owns the struct).
+// Sizes are handed back on realloc and free so allocators that don't keep headers (arenas) still know them.
+// context is passed through untouched, it's the arena for arena_allocator and NULL for the others
+struct allocator {
+    const char* name;
+    void* (*malloc)(void* context, size_t size);
+    void* (*realloc)(void* context, void* ptr, size_t old_size, size_t new_size);
+    void (*free)(void* context, void* ptr, size_t size);
+    void* context;
+};
+
+extern const struct allocator allocator_libc;
+extern const struct allocator allocator_my_malloc; // huge pages when the size calls for them, see allocation.c
+
+// These exit on failure like the rest of the containers do, so callers don't check for NULL
+void* allocator_malloc(const struct allocator* allocator, size_t size);
+void* allocator_realloc(const struct allocator* allocator, void* ptr, size_t old_size, size_t new_size);
+void allocator_free(const struct allocator* allocator, void* ptr, size_t size);
+
+// Bump allocator over a chain of blocks. Freeing is a no-op, everything goes at once with arena_free or arena_reset.
+// Not thread safe, give each thread its own arena
+struct arena_block {
+    struct arena_block* next;
+    size_t size;
+    size_t used;
+    _Alignas(16) unsigned char data[];
+};
+
+struct arena {
+    struct arena_block* blocks; // newest first, allocations come from the first one
+    size_t block_size;
+    size_t bytes_allocated;
+    struct allocator allocator; // context points back at this arena
+};
+
+// block_size of 0 picks the default, allocations bigger than a block get a block of their own
+struct arena* arena_new(size_t block_size);
+void arena_free(struct arena* arena);
+// Forgets every allocation but keeps the first block around for reuse
+void arena_reset(struct arena* arena);
+const struct allocator* arena_allocator(struct arena* arena);
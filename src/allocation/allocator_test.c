@@ -0,0 +1,172 @@
+// ReSharper disable CppLocalVariableMayBeConst
+#pragma once
+#include "allocator.h"
+#include "../hashmap/hashmap.h"
+#include "../linkedlist/linkedlist.h"
+#include "../vector/vector.h"
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Wraps libc and keeps count, so the tests can see every byte handed out comes back with the right size
+struct counting_context {
+    long long live_bytes;
+    long long calls;
+};
+
+static void* counting_malloc(void* context, size_t size) {
+    struct counting_context* counts = context;
+    counts->live_bytes += (long long) size;
+    counts->calls++;
+    return malloc(size);
+}
+
+static void* counting_realloc(void* context, void* ptr, size_t old_size, size_t new_size) {
+    struct counting_context* counts = context;
+    counts->live_bytes += (long long) new_size - (long long) old_size;
+    counts->calls++;
+    return realloc(ptr, new_size);
+}
+
+static void counting_free(void* context, void* ptr, size_t size) {
+    struct counting_context* counts = context;
+    counts->live_bytes -= (long long) size;
+    counts->calls++;
+    free(ptr);
+}
+
+void testAllocator() {
+    printf("=== Allocator Test ===\n\n");
+
+    // Test 1: Arena hands out aligned, separate blocks and grows in place at the end
+    printf("Test 1: Arena allocations\n");
+    struct arena* arena = arena_new(256);
+    const struct allocator* allocator = arena_allocator(arena);
+
+    char* first = allocator_malloc(allocator, 10);
+    char* second = allocator_malloc(allocator, 10);
+    assert((uintptr_t) first % 16 == 0 && (uintptr_t) second % 16 == 0);
+    assert(second >= first + 10);
+    memset(first, 'a', 10);
+    memset(second, 'b', 10);
+
+    char* grown = allocator_realloc(allocator, second, 10, 100);
+    assert(grown == second);
+    assert(grown[9] == 'b');
+
+    // Not the last allocation any more, so it has to move
+    char* moved = allocator_realloc(allocator, first, 10, 40);
+    assert(moved != first);
+    assert(memcmp(moved, "aaaaaaaaaa", 10) == 0);
+
+    // Bigger than a block, gets one of its own
+    char* big = allocator_malloc(allocator, 4096);
+    memset(big, 'c', 4096);
+    assert(arena->bytes_allocated >= 4096 + 100 + 40 + 16);
+
+    allocator_free(allocator, big, 4096);
+    arena_reset(arena);
+    assert(arena->bytes_allocated == 0);
+    assert(arena->blocks == NULL || arena->blocks->next == NULL);
+    arena_free(arena);
+    printf("✓ Arena allocations working correctly\n\n");
+
+    // Test 2: Containers return exactly what they took from their allocator
+    printf("Test 2: Containers with a counting allocator\n");
+    struct counting_context counts = {0, 0};
+    const struct allocator counting = {"counting", counting_malloc, counting_realloc, counting_free, &counts};
+
+    struct hashmap* map = new_hashmap_with_allocator(&counting);
+    for (int i = 0; i < 1000; i++) {
+        hashmap_put(map, i, i * 2);
+    }
+    for (int i = 0; i < 1000; i += 3) {
+        hashmap_remove(map, i);
+    }
+    assert(hashmap_get(map, 1)->value == 2);
+    assert(counts.calls > 0);
+    free_hashmap(map);
+    assert(counts.live_bytes == 0);
+
+    counts.calls = 0;
+    struct vector* vec = vector_new_with_allocator(&counting);
+    assert(counts.live_bytes == sizeof(struct vector)); // the struct too, not just the buffers
+    for (int i = 0; i < 1000; i++) {
+        vector_push(vec, i);
+    }
+    vector_shrink_to_fit(vec);
+    long long calls_before_sort = counts.calls;
+    vector_sort(vec); // scratch buffers come from the allocator too
+    vector_sort_parallel(vec, 2);
+    assert(counts.calls == calls_before_sort + 4);
+    assert(*vector_at(vec, 999) == 999);
+    struct vector* cow = vector_clone_cow(vec);
+    vector_push(cow, 1000); // forces the copy, which comes from the same allocator
+    struct vector* clone = vector_clone(vec);
+    assert(clone->allocator == &counting);
+    assert(*vector_at(cow, 1000) == 1000 && *vector_at(clone, 999) == 999);
+    assert(counts.calls > 0);
+    vector_free(clone);
+    vector_free(cow);
+    vector_free(vec);
+    assert(counts.live_bytes == 0);
+
+    counts.calls = 0;
+    struct list* list = newListWithAllocator(&counting);
+    assert(counts.live_bytes == sizeof(struct list));
+    for (int i = 0; i < 100; i++) {
+        addLast(list, i);
+    }
+    list_enable_skip_index(list);
+    assert(getAt(list, 70) == 70);
+    addBefore(list, 10, -1); // the index is kept up to date here, not rebuilt
+    assert(getAt(list, 10) == -1 && getAt(list, 70) == 69);
+    struct list* rest = list_split_at(list, 50);
+    assert(rest->allocator == &counting);
+    list_splice(list, 0, rest);
+    assert(list->size == 101 && rest->size == 0);
+    removeFirst(list);
+    assert(counts.calls > 0);
+    freeList(rest);
+    freeList(list);
+    assert(counts.live_bytes == 0);
+
+    counts.calls = 0;
+    struct list* pooled = newPooledListWithAllocator(&counting);
+    for (int i = 0; i < 1000; i++) {
+        addLast(pooled, i);
+    }
+    assert(counts.calls > 0 && counts.calls < 1000); // one call per page, not per entry
+    struct list* sharing = newListSharingPool(pooled);
+    addLast(sharing, 1);
+    freeList(pooled);
+    freeList(sharing);
+    assert(counts.live_bytes == 0);
+    printf("✓ Containers with a counting allocator working correctly\n\n");
+
+    // Test 3: Containers on an arena and on my_malloc
+    printf("Test 3: Containers on an arena and my_malloc\n");
+    arena = arena_new(0);
+    map = new_hashmap_with_allocator(arena_allocator(arena));
+    list = newPooledListWithAllocator(arena_allocator(arena));
+    vec = vector_new_with_allocator(&allocator_my_malloc);
+    for (int i = 0; i < 10000; i++) {
+        hashmap_put(map, i, -i);
+        addFirst(list, i);
+        vector_push(vec, i);
+    }
+    for (int i = 0; i < 10000; i++) {
+        assert(hashmap_get(map, i)->value == -i);
+        assert(*vector_at(vec, i) == i);
+    }
+    assert(getFirst(list) == 9999 && getLast(list) == 0);
+    free_hashmap(map);
+    freeList(list);
+    vector_free(vec);
+    arena_free(arena);
+    printf("✓ Containers on an arena and my_malloc working correctly\n\n");
+
+    printf("✓ All allocator tests passed!\n");
+}
@@ -0,0 +1,422 @@
+// Offline report for traces written by my_malloc_trace_start / CSTUFF_ALLOC_TRACE, see allocation_trace.h.
+// Built as its own executable, it doesn't link the allocator:
+//   cstuff_trace_report <trace file> [--top <count>] [--depth <frames>] [--binary <executable>]
+// --depth is how many call site frames make up one site (default 2, so the caller of a container's
+// allocator wrapper is told apart), --binary resolves the sites to functions with addr2line.
+
+// popen, for addr2line
+#define _POSIX_C_SOURCE 200809L
+#include "allocation_trace.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Lifetimes go into decades from 100ns up
+#define LIFETIME_BUCKETS 9
+
+static const char* const lifetime_labels[LIFETIME_BUCKETS] = {
+    "<100ns", "<1us", "<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s",
+};
+
+struct site {
+    uint64_t frames[ALLOC_TRACE_FRAMES];
+    long long allocations;
+    long long bytes;
+    long long frees;
+    long long live_count;
+    long long live_bytes;
+    uint64_t lifetime_total_ns;
+    long long lifetimes[LIFETIME_BUCKETS];
+};
+
+struct live_allocation {
+    uint64_t address; // 0 marks an empty slot
+    uint64_t size;
+    uint64_t timestamp_ns;
+    int site;
+};
+
+struct report {
+    int depth;
+    struct site* sites;
+    int site_count;
+    int* site_slots; // open addressing over sites, -1 is empty
+    int site_slot_count;
+
+    struct live_allocation* live; // open addressing with linear probing, keyed by address
+    long long live_slot_count;
+    long long live_count;
+    long long live_bytes;
+    long long peak_live_bytes;
+
+    long long lifetimes[LIFETIME_BUCKETS];
+    long long untracked_frees; // of memory allocated before the trace started
+};
+
+static void* checked_realloc(void* ptr, size_t size) {
+    void* new_ptr = realloc(ptr, size);
+    if (new_ptr == NULL) {
+        fprintf(stderr, "trace_report: out of memory\n");
+        exit(1);
+    }
+    return new_ptr;
+}
+
+static uint64_t hash_u64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    return value;
+}
+
+static uint64_t hash_frames(const uint64_t* frames, int depth) {
+    uint64_t hash = 0;
+    for (int i = 0; i < depth; i++) {
+        hash = hash_u64(hash ^ frames[i]);
+    }
+    return hash;
+}
+
+static void grow_site_slots(struct report* report) {
+    free(report->site_slots);
+    report->site_slot_count = report->site_slot_count > 0 ? report->site_slot_count * 2 : 1024;
+    report->site_slots = checked_realloc(NULL, sizeof(int) * report->site_slot_count);
+    memset(report->site_slots, -1, sizeof(int) * report->site_slot_count);
+
+    for (int i = 0; i < report->site_count; i++) {
+        size_t slot = hash_frames(report->sites[i].frames, report->depth) & (report->site_slot_count - 1);
+        while (report->site_slots[slot] != -1) {
+            slot = (slot + 1) & (report->site_slot_count - 1);
+        }
+        report->site_slots[slot] = i;
+    }
+}
+
+static int find_site(struct report* report, const uint64_t* frames) {
+    if ((report->site_count + 1) * 2 > report->site_slot_count) {
+        grow_site_slots(report);
+    }
+
+    size_t slot = hash_frames(frames, report->depth) & (report->site_slot_count - 1);
+    while (report->site_slots[slot] != -1) {
+        const int index = report->site_slots[slot];
+        if (memcmp(report->sites[index].frames, frames, sizeof(uint64_t) * report->depth) == 0) {
+            return index;
+        }
+        slot = (slot + 1) & (report->site_slot_count - 1);
+    }
+
+    if ((report->site_count & (report->site_count - 1)) == 0) {
+        report->sites = checked_realloc(report->sites, sizeof(struct site) * (report->site_count > 0 ? report->site_count * 2 : 1));
+    }
+    struct site* site = &report->sites[report->site_count];
+    memset(site, 0, sizeof(struct site));
+    memcpy(site->frames, frames, sizeof(uint64_t) * report->depth);
+
+    report->site_slots[slot] = report->site_count;
+    return report->site_count++;
+}
+
+static void insert_live(struct report* report, struct live_allocation allocation);
+
+static void grow_live(struct report* report) {
+    struct live_allocation* old = report->live;
+    const long long old_count = report->live_slot_count;
+
+    report->live_slot_count = old_count > 0 ? old_count * 2 : 1 << 16;
+    report->live = checked_realloc(NULL, sizeof(struct live_allocation) * report->live_slot_count);
+    memset(report->live, 0, sizeof(struct live_allocation) * report->live_slot_count);
+    report->live_count = 0;
+
+    for (long long i = 0; i < old_count; i++) {
+        if (old[i].address != 0) {
+            insert_live(report, old[i]);
+        }
+    }
+    free(old);
+}
+
+static void insert_live(struct report* report, struct live_allocation allocation) {
+    if ((report->live_count + 1) * 2 > report->live_slot_count) {
+        grow_live(report);
+    }
+
+    size_t slot = hash_u64(allocation.address) & (report->live_slot_count - 1);
+    while (report->live[slot].address != 0) {
+        slot = (slot + 1) & (report->live_slot_count - 1);
+    }
+    report->live[slot] = allocation;
+    report->live_count++;
+}
+
+// Takes address out of the live table, backward shift deletion keeps the probe chains intact
+static bool remove_live(struct report* report, uint64_t address, struct live_allocation* out) {
+    if (report->live_slot_count == 0) {
+        return false;
+    }
+
+    const size_t mask = report->live_slot_count - 1;
+    size_t slot = hash_u64(address) & mask;
+    while (report->live[slot].address != address) {
+        if (report->live[slot].address == 0) {
+            return false;
+        }
+        slot = (slot + 1) & mask;
+    }
+    *out = report->live[slot];
+
+    size_t hole = slot;
+    size_t next = (slot + 1) & mask;
+    while (report->live[next].address != 0) {
+        const size_t home = hash_u64(report->live[next].address) & mask;
+        // Moves back into the hole unless its home is between the hole and where it is now
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            report->live[hole] = report->live[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    report->live[hole].address = 0;
+    report->live_count--;
+    return true;
+}
+
+static int lifetime_bucket(uint64_t lifetime_ns) {
+    int bucket = 0;
+    uint64_t limit = 100;
+    while (bucket < LIFETIME_BUCKETS - 1 && lifetime_ns >= limit) {
+        bucket++;
+        limit *= 10;
+    }
+    return bucket;
+}
+
+static void end_lifetime(struct report* report, uint64_t address, uint64_t timestamp_ns) {
+    struct live_allocation allocation;
+    if (!remove_live(report, address, &allocation)) {
+        report->untracked_frees++;
+        return;
+    }
+
+    struct site* site = &report->sites[allocation.site];
+    const uint64_t lifetime = timestamp_ns - allocation.timestamp_ns;
+    const int bucket = lifetime_bucket(lifetime);
+
+    site->frees++;
+    site->live_count--;
+    site->live_bytes -= (long long) allocation.size;
+    site->lifetime_total_ns += lifetime;
+    site->lifetimes[bucket]++;
+    report->lifetimes[bucket]++;
+    report->live_bytes -= (long long) allocation.size;
+}
+
+static void start_lifetime(struct report* report, const struct alloc_trace_record* record) {
+    const int index = find_site(report, record->call_sites);
+    struct site* site = &report->sites[index];
+    site->allocations++;
+    site->bytes += (long long) record->size;
+    site->live_count++;
+    site->live_bytes += (long long) record->size;
+
+    insert_live(report, (struct live_allocation) {record->address, record->size, record->timestamp_ns, index});
+    report->live_bytes += (long long) record->size;
+    if (report->live_bytes > report->peak_live_bytes) {
+        report->peak_live_bytes = report->live_bytes;
+    }
+}
+
+static void replay(struct report* report, const struct alloc_trace_record* record) {
+    switch (record->kind) {
+        case ALLOC_TRACE_MALLOC:
+            start_lifetime(report, record);
+            break;
+        case ALLOC_TRACE_REALLOC:
+            if (record->old_address != 0) {
+                end_lifetime(report, record->old_address, record->timestamp_ns);
+            }
+            start_lifetime(report, record);
+            break;
+        case ALLOC_TRACE_FREE:
+            end_lifetime(report, record->address, record->timestamp_ns);
+            break;
+        default:
+            break;
+    }
+}
+
+// Calls on the same address can get the same timestamp, the sequence keeps them in the order they really happened
+static int compare_records(const void* a, const void* b) {
+    const struct alloc_trace_record* l = a;
+    const struct alloc_trace_record* r = b;
+    if (l->timestamp_ns != r->timestamp_ns) {
+        return (l->timestamp_ns > r->timestamp_ns) - (l->timestamp_ns < r->timestamp_ns);
+    }
+    return (l->sequence > r->sequence) - (l->sequence < r->sequence);
+}
+
+static int compare_by_allocations(const void* a, const void* b) {
+    const long long l = ((const struct site*) a)->allocations;
+    const long long r = ((const struct site*) b)->allocations;
+    return (l < r) - (l > r);
+}
+
+static int compare_by_live_bytes(const void* a, const void* b) {
+    const long long l = ((const struct site*) a)->live_bytes;
+    const long long r = ((const struct site*) b)->live_bytes;
+    return (l < r) - (l > r);
+}
+
+static void print_frame(uint64_t frame, uint64_t load_base, const char* binary) {
+    const uint64_t offset = frame - load_base;
+    if (binary == NULL) {
+        printf("    0x%" PRIx64 "\n", offset);
+        return;
+    }
+
+    char command[4096];
+    snprintf(command, sizeof(command), "addr2line -f -s -e '%s' 0x%" PRIx64 " 2>/dev/null", binary, offset);
+    FILE* pipe = popen(command, "r");
+    char function[1024] = "??";
+    char location[1024] = "??";
+    if (pipe != NULL) {
+        if (fgets(function, sizeof(function), pipe) != NULL) {
+            function[strcspn(function, "\n")] = '\0';
+        }
+        if (fgets(location, sizeof(location), pipe) != NULL) {
+            location[strcspn(location, "\n")] = '\0';
+        }
+        pclose(pipe);
+    }
+    printf("    0x%" PRIx64 " %s %s\n", offset, function, location);
+}
+
+static void print_site(const struct site* site, int depth, uint64_t load_base, const char* binary) {
+    for (int i = 0; i < depth && site->frames[i] != 0; i++) {
+        print_frame(site->frames[i], load_base, binary);
+    }
+}
+
+static void print_lifetimes(const long long* lifetimes) {
+    for (int i = 0; i < LIFETIME_BUCKETS; i++) {
+        printf(" %s:%lld", lifetime_labels[i], lifetimes[i]);
+    }
+    printf("\n");
+}
+
+static void print_usage() {
+    fprintf(stderr, "usage: cstuff_trace_report <trace file> [--top <count>] [--depth <frames>] [--binary <executable>]\n");
+}
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    const char* binary = NULL;
+    int top = 10;
+    int depth = 2;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--binary") == 0 && i + 1 < argc) {
+            binary = argv[++i];
+        } else if (path == NULL && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (path == NULL || top <= 0 || depth < 1 || depth > ALLOC_TRACE_FRAMES) {
+        print_usage();
+        return 1;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "trace_report: can't open %s\n", path);
+        return 1;
+    }
+
+    struct alloc_trace_header header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, ALLOC_TRACE_MAGIC, 8) != 0
+        || header.version != ALLOC_TRACE_VERSION || header.record_size != sizeof(struct alloc_trace_record)) {
+        fprintf(stderr, "trace_report: %s isn't a version %i allocation trace\n", path, ALLOC_TRACE_VERSION);
+        fclose(file);
+        return 1;
+    }
+
+    struct alloc_trace_record* records = NULL;
+    size_t record_count = 0;
+    size_t record_capacity = 0;
+    while (true) {
+        if (record_count == record_capacity) {
+            record_capacity = record_capacity > 0 ? record_capacity * 2 : 1 << 16;
+            records = checked_realloc(records, sizeof(struct alloc_trace_record) * record_capacity);
+        }
+        const size_t read = fread(records + record_count, sizeof(struct alloc_trace_record),
+                                  record_capacity - record_count, file);
+        record_count += read;
+        if (read == 0) {
+            break;
+        }
+    }
+    fclose(file);
+
+    qsort(records, record_count, sizeof(struct alloc_trace_record), compare_records);
+
+    struct report report = {0};
+    report.depth = depth;
+    for (size_t i = 0; i < record_count; i++) {
+        replay(&report, &records[i]);
+    }
+
+    long long allocations = 0;
+    long long bytes = 0;
+    for (int i = 0; i < report.site_count; i++) {
+        allocations += report.sites[i].allocations;
+        bytes += report.sites[i].bytes;
+    }
+    const double duration_ms = record_count > 0
+                                   ? (double) (records[record_count - 1].timestamp_ns - records[0].timestamp_ns) / 1e6
+                                   : 0;
+
+    printf("%zu records over %.3f ms: %lld allocations (%lld bytes), peak live %lld bytes, %lld frees of untraced memory\n",
+           record_count, duration_ms, allocations, bytes, report.peak_live_bytes, report.untracked_frees);
+    printf("lifetimes:");
+    print_lifetimes(report.lifetimes);
+    if (binary == NULL) {
+        printf("sites are offsets into the executable, resolve them with addr2line -f -e <executable> or pass --binary\n");
+    }
+
+    qsort(report.sites, report.site_count, sizeof(struct site), compare_by_allocations);
+    printf("\nTop allocation sites:\n");
+    for (int i = 0; i < report.site_count && i < top; i++) {
+        const struct site* site = &report.sites[i];
+        printf("#%i %lld allocations, %lld bytes, avg %lld bytes, avg lifetime %.0f ns\n  lifetimes:",
+               i + 1, site->allocations, site->bytes, site->bytes / site->allocations,
+               site->frees > 0 ? (double) site->lifetime_total_ns / (double) site->frees : 0.0);
+        print_lifetimes(site->lifetimes);
+        print_site(site, depth, header.load_base, binary);
+    }
+
+    qsort(report.sites, report.site_count, sizeof(struct site), compare_by_live_bytes);
+    printf("\nLeaks, still allocated at the end of the trace: %lld allocations, %lld bytes\n",
+           report.live_count, report.live_bytes);
+    for (int i = 0; i < report.site_count && i < top && report.sites[i].live_bytes > 0; i++) {
+        const struct site* site = &report.sites[i];
+        printf("#%i %lld allocations, %lld bytes\n", i + 1, site->live_count, site->live_bytes);
+        print_site(site, depth, header.load_base, binary);
+    }
+
+    free(records);
+    free(report.sites);
+    free(report.site_slots);
+    free(report.live);
+    return 0;
+}
@@ -0,0 +1,295 @@
+// NOLINTNEXTLINE
+#define _GNU_SOURCE
+#include "bench.h"
+#include "perf_counters.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+
+struct bench_config bench_config = {
+    .warmup = 1,
+    .repetitions = 5,
+    .clock = BENCH_CLOCK_MONOTONIC,
+    .cpu = -1,
+    .format = BENCH_FORMAT_CSV,
+    .filter = NULL,
+    .output = NULL,
+    .perf = false,
+};
+
+volatile long long bench_sink;
+
+#ifdef BENCH_HAS_TSC
+static double tsc_ns_per_tick = 0;
+#endif
+static bool is_first_result = true;
+
+static struct perf_counters counters;
+static int counted_rounds = 0; // measured rounds in counters since the last report
+
+void bench_print_usage(FILE* stream) {
+    fprintf(stream,
+            "  --csv               CSV output (default)\n"
+            "  --json              JSON array output\n"
+            "  --output <path>     write results to a file instead of stdout\n"
+            "  --warmup <n>        untimed rounds before measuring (default 1)\n"
+            "  --repetitions <n>   timed rounds per measurement (default 5)\n"
+            "  --rdtsc             time with the TSC instead of clock_gettime (x86 only)\n"
+            "  --cpu <n>           pin to CPU n\n"
+            "  --filter <text>     only benchmarks whose name contains text\n"
+            "  --perf              add hardware counters per operation\n");
+}
+
+// Parses a non negative int option value, false if it's missing or not a number
+static bool parse_count(int argc, char** argv, int* i, int* out) {
+    if (*i + 1 >= argc) {
+        return false;
+    }
+
+    char* end;
+    const long value = strtol(argv[++*i], &end, 10);
+    if (*end != '\0' || value < 0 || value > 1000000) {
+        return false;
+    }
+
+    *out = (int) value;
+    return true;
+}
+
+bool bench_parse_args(int argc, char** argv) {
+    for (int i = 0; i < argc; i++) {
+        const char* arg = argv[i];
+
+        if (strcmp(arg, "--csv") == 0) {
+            bench_config.format = BENCH_FORMAT_CSV;
+        } else if (strcmp(arg, "--json") == 0) {
+            bench_config.format = BENCH_FORMAT_JSON;
+        } else if (strcmp(arg, "--perf") == 0) {
+            bench_config.perf = true;
+        } else if (strcmp(arg, "--rdtsc") == 0) {
+#ifdef BENCH_HAS_TSC
+            bench_config.clock = BENCH_CLOCK_RDTSC;
+#else
+            fprintf(stderr, "bench: no TSC on this architecture, timing with clock_gettime\n");
+#endif
+        } else if (strcmp(arg, "--warmup") == 0) {
+            if (!parse_count(argc, argv, &i, &bench_config.warmup)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--repetitions") == 0) {
+            if (!parse_count(argc, argv, &i, &bench_config.repetitions) || bench_config.repetitions == 0) {
+                return false;
+            }
+        } else if (strcmp(arg, "--cpu") == 0) {
+            if (!parse_count(argc, argv, &i, &bench_config.cpu)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--filter") == 0) {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            bench_config.filter = argv[++i];
+        } else if (strcmp(arg, "--output") == 0) {
+            if (i + 1 >= argc) {
+                return false;
+            }
+            bench_config.output = fopen(argv[++i], "w");
+            if (bench_config.output == NULL) {
+                fprintf(stderr, "bench: can't open %s\n", argv[i]);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static double monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+#ifdef BENCH_HAS_TSC
+// Counts TSC ticks over 20ms of the monotonic clock
+static void calibrate_tsc() {
+    const double start_ns = monotonic_ns();
+    const unsigned long long start_ticks = __rdtsc();
+    while (monotonic_ns() - start_ns < 20e6) {
+    }
+    const unsigned long long ticks = __rdtsc() - start_ticks;
+    const double elapsed_ns = monotonic_ns() - start_ns;
+
+    tsc_ns_per_tick = elapsed_ns / (double) ticks;
+}
+#endif
+
+void bench_begin() {
+    if (bench_config.output == NULL) {
+        bench_config.output = stdout;
+    }
+
+#ifndef __OPTIMIZE__
+    fprintf(stderr, "bench: built without optimizations, numbers won't mean much\n");
+#endif
+
+    if (bench_config.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(bench_config.cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            fprintf(stderr, "bench: can't pin to cpu %i, running unpinned\n", bench_config.cpu);
+        }
+    }
+
+#ifdef BENCH_HAS_TSC
+    if (bench_config.clock == BENCH_CLOCK_RDTSC) {
+        calibrate_tsc();
+    }
+#endif
+
+    if (bench_config.perf && !perf_counters_open(&counters)) {
+        fprintf(stderr, "bench: no hardware counters available (check perf_event_paranoid), reporting -1\n");
+    } else if (bench_config.perf && counters.is_thread_only) {
+        fprintf(stderr, "bench: hardware counters can't follow threads here, they only count the main thread\n");
+    }
+}
+
+void bench_end() {
+    if (bench_config.format == BENCH_FORMAT_JSON) {
+        fprintf(bench_config.output, is_first_result ? "[]\n" : "\n]\n");
+    }
+
+    if (bench_config.perf) {
+        perf_counters_close(&counters);
+    }
+
+    fflush(bench_config.output);
+    if (bench_config.output != stdout) {
+        fclose(bench_config.output);
+    }
+}
+
+double bench_now_ns() {
+#ifdef BENCH_HAS_TSC
+    if (bench_config.clock == BENCH_CLOCK_RDTSC) {
+        return (double) __rdtsc() * tsc_ns_per_tick;
+    }
+#endif
+
+    return monotonic_ns();
+}
+
+void bench_counters_start() {
+    if (bench_config.perf) {
+        perf_counters_start(&counters);
+    }
+}
+
+void bench_counters_stop(bool is_measured) {
+    if (!bench_config.perf) {
+        return;
+    }
+
+    // Warmup rounds are counted too, so take their totals back out
+    if (!is_measured) {
+        const struct perf_counters before = counters;
+        perf_counters_stop(&counters);
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            counters.values[i] = before.values[i];
+        }
+        return;
+    }
+
+    perf_counters_stop(&counters);
+    counted_rounds++;
+}
+
+// Adds the counters per operation over the measured rounds, -1 where unavailable or not measured
+static void write_counters(FILE* out, long long operations) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        const double per_op = counted_rounds > 0
+                                  ? perf_counter_per_op(&counters, i, operations * counted_rounds)
+                                  : -1;
+        if (bench_config.format == BENCH_FORMAT_JSON) {
+            fprintf(out, ", \"%s\": %.3f", perf_counter_name(i), per_op);
+        } else {
+            fprintf(out, ",%.3f", per_op);
+        }
+    }
+
+    perf_counters_reset(&counters);
+    counted_rounds = 0;
+}
+
+bool bench_is_selected(const char* benchmark) {
+    return bench_config.filter == NULL || strstr(benchmark, bench_config.filter) != NULL;
+}
+
+static int compare_double(const void* a, const void* b) {
+    const double l = *(const double*) a;
+    const double r = *(const double*) b;
+    return (l > r) - (l < r);
+}
+
+// Nearest rank percentile of sorted samples
+static double percentile(const double* sorted, int count, int percent) {
+    int rank = (percent * count + 99) / 100;
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[rank - 1];
+}
+
+void bench_report(const char* benchmark, const char* variant, int size, long long operations,
+                  double* samples_ns, int count, long long counter) {
+    qsort(samples_ns, count, sizeof(double), compare_double);
+
+    const double per_op = operations > 0 ? 1.0 / (double) operations : 1.0;
+    double mean = 0;
+    for (int i = 0; i < count; i++) {
+        mean += samples_ns[i];
+    }
+    mean = mean / count * per_op;
+
+    const double min = samples_ns[0] * per_op;
+    const double p50 = percentile(samples_ns, count, 50) * per_op;
+    const double p90 = percentile(samples_ns, count, 90) * per_op;
+    const double p99 = percentile(samples_ns, count, 99) * per_op;
+    const double max = samples_ns[count - 1] * per_op;
+
+    FILE* out = bench_config.output;
+    if (bench_config.format == BENCH_FORMAT_JSON) {
+        fprintf(out, "%s\n  {\"benchmark\": \"%s\", \"variant\": \"%s\", \"size\": %i, \"operations\": %lld, "
+                "\"repetitions\": %i, \"ns_per_op\": %.3f, \"min\": %.3f, \"p90\": %.3f, \"p99\": %.3f, "
+                "\"max\": %.3f, \"mean\": %.3f, \"counter\": %lld",
+                is_first_result ? "[" : ",", benchmark, variant, size, operations, count,
+                p50, min, p90, p99, max, mean, counter);
+        if (bench_config.perf) {
+            write_counters(out, operations);
+        }
+        fprintf(out, "}");
+    } else {
+        if (is_first_result) {
+            fprintf(out, "benchmark,variant,size,operations,repetitions,ns_per_op,min,p90,p99,max,mean,counter");
+            for (int i = 0; bench_config.perf && i < PERF_COUNTER_COUNT; i++) {
+                fprintf(out, ",%s", perf_counter_name(i));
+            }
+            fprintf(out, "\n");
+        }
+        fprintf(out, "%s,%s,%i,%lld,%i,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%lld", benchmark, variant, size,
+                operations, count, p50, min, p90, p99, max, mean, counter);
+        if (bench_config.perf) {
+            write_counters(out, operations);
+        }
+        fprintf(out, "\n");
+    }
+    is_first_result = false;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <stdbool.h>
+#include <stdio.h>
+
+// Shared benchmark harness. Every measurement runs a few warmup rounds that are thrown
+// away, then a number of timed repetitions, and reports percentiles of the time per
+// operation so numbers from different runs and releases can be compared.
+//
+// Timing is clock_gettime(CLOCK_MONOTONIC) by default, or the TSC (calibrated against
+// the monotonic clock at startup) with --rdtsc. Other architectures than x86 ignore --rdtsc
+// with a warning. --cpu pins the process to one core so the scheduler doesn't move it
+// between caches mid run. --perf adds hardware counters per operation (see perf_counters.h),
+// reported as -1 where the machine doesn't allow them.
+
+enum bench_format {
+    BENCH_FORMAT_CSV,
+    BENCH_FORMAT_JSON,
+};
+
+enum bench_clock {
+    BENCH_CLOCK_MONOTONIC,
+    BENCH_CLOCK_RDTSC,
+};
+
+struct bench_config {
+    int warmup;
+    int repetitions;
+    enum bench_clock clock;
+    int cpu; // -1 to leave scheduling alone
+    enum bench_format format;
+    const char* filter; // only benchmarks whose name contains this, NULL for all
+    FILE* output;
+    bool perf;
+};
+
+extern struct bench_config bench_config;
+
+// Keeps results alive so the compiler can't drop the work that produced them
+extern volatile long long bench_sink;
+
+// Reads the options above from argv (unknown ones are left for the caller), false on a bad value
+bool bench_parse_args(int argc, char** argv);
+void bench_print_usage(FILE* stream);
+
+// Pins the CPU and calibrates the clock, call before the first measurement
+void bench_begin();
+// Finishes the output (closes the JSON array)
+void bench_end();
+
+double bench_now_ns();
+bool bench_is_selected(const char* benchmark);
+
+// Brackets the timed part of a round for --perf, only rounds stopped with is_measured count
+void bench_counters_start();
+void bench_counters_stop(bool is_measured);
+
+// samples_ns holds the time of each repetition for all operations, counter is reported as is (-1 when unused)
+void bench_report(const char* benchmark, const char* variant, int size, long long operations,
+                  double* samples_ns, int count, long long counter);
+
+// Runs setup, times body, runs teardown; warmup + repetitions times, then reports.
+// The three arguments are statements, variables declared in setup are visible in body and teardown.
+#define BENCH_MEASURE(benchmark, variant, size, operations, setup, body, teardown)              \
+    do {                                                                                      \
+        if (!bench_is_selected(benchmark)) {                                                  \
+            break;                                                                            \
+        }                                                                                     \
+        double bench_samples_[bench_config.repetitions];                                      \
+        for (int bench_round_ = 0; bench_round_ < bench_config.warmup + bench_config.repetitions; \
+             bench_round_++) {                                                                \
+            setup;                                                                            \
+            bench_counters_start();                                                           \
+            const double bench_start_ = bench_now_ns();                                       \
+            body;                                                                             \
+            const double bench_elapsed_ = bench_now_ns() - bench_start_;                      \
+            bench_counters_stop(bench_round_ >= bench_config.warmup);                         \
+            teardown;                                                                         \
+            if (bench_round_ >= bench_config.warmup) {                                        \
+                bench_samples_[bench_round_ - bench_config.warmup] = bench_elapsed_;          \
+            }                                                                                 \
+        }                                                                                     \
+        bench_report(benchmark, variant, size, operations, bench_samples_,                    \
+                     bench_config.repetitions, -1);                                           \
+    } while (0)
@@ -0,0 +1,117 @@
+#include "bench.h"
+#include "benchmarks.h"
+#include "../allocation/allocator.h"
+#include "../hashmap/hashmap.h"
+#include "../linkedlist/linkedlist.h"
+#include "../vector/vector.h"
+
+#include <stdlib.h>
+
+// my_malloc and an arena against libc malloc, first on raw allocation patterns,
+// then behind the containers that take an allocator at construction
+
+#define LIVE_ALLOCATIONS 4096
+#define ALLOCATOR_COUNT 3
+
+static unsigned int random_state = 521288629u;
+
+static unsigned int next_random() {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+// The arena is made fresh for every round so it starts out empty like the other two
+static const struct allocator* pick_allocator(int index, struct arena* arena) {
+    switch (index) {
+        case 0:
+            return &allocator_libc;
+        case 1:
+            return &allocator_my_malloc;
+        default:
+            return arena_allocator(arena);
+    }
+}
+
+static const char* const allocator_names[ALLOCATOR_COUNT] = {"libc", "my_malloc", "arena"};
+
+static void bench_raw_patterns() {
+    static void* live[LIVE_ALLOCATIONS];
+    size_t sizes[LIVE_ALLOCATIONS];
+    for (int i = 0; i < LIVE_ALLOCATIONS; i++) {
+        // Mostly container sized, some big ones
+        sizes[i] = next_random() % 16 == 0 ? 4096 + next_random() % 65536 : 16 + next_random() % 240;
+    }
+
+    const int operations = 100000;
+    for (int a = 0; a < ALLOCATOR_COUNT; a++) {
+        const char* name = allocator_names[a];
+
+        BENCH_MEASURE("alloc_free_pair", name, 64, operations,
+                      struct arena* arena = arena_new(0); const struct allocator* allocator = pick_allocator(a, arena),
+                      for (int i = 0; i < operations; i++) {
+                          void* ptr = allocator_malloc(allocator, 64);
+                          bench_sink += (long long) (size_t) ptr;
+                          allocator_free(allocator, ptr, 64);
+                      },
+                      arena_free(arena));
+
+        // Allocates a batch of mixed sizes and frees it in a shuffled order
+        BENCH_MEASURE("alloc_batch_free", name, LIVE_ALLOCATIONS, LIVE_ALLOCATIONS * 2LL,
+                      struct arena* arena = arena_new(0); const struct allocator* allocator = pick_allocator(a, arena),
+                      for (int i = 0; i < LIVE_ALLOCATIONS; i++) live[i] = allocator_malloc(allocator, sizes[i]);
+                      for (int i = 0; i < LIVE_ALLOCATIONS; i++) {
+                          const int j = (int) ((i * 2654435761u) % LIVE_ALLOCATIONS);
+                          allocator_free(allocator, live[j], sizes[j]);
+                      },
+                      arena_free(arena));
+
+        // Doubling a buffer the way a vector grows
+        BENCH_MEASURE("realloc_growth", name, 1 << 20, 17,
+                      struct arena* arena = arena_new(0); const struct allocator* allocator = pick_allocator(a, arena);
+                      void* ptr = NULL,
+                      for (size_t size = 16; size <= (1 << 20); size *= 2) ptr = allocator_realloc(allocator, ptr, size / 2, size),
+                      allocator_free(allocator, ptr, 1 << 20); arena_free(arena));
+    }
+}
+
+// The same container work with each allocator underneath, teardown (and so the arena's one shot free) isn't timed
+static void bench_containers(int size) {
+    for (int a = 0; a < ALLOCATOR_COUNT; a++) {
+        const char* name = allocator_names[a];
+
+        BENCH_MEASURE("hashmap_put_by_allocator", name, size, size,
+                      struct arena* arena = arena_new(0);
+                      struct hashmap* map = new_hashmap_with_allocator(pick_allocator(a, arena)),
+                      for (int i = 0; i < size; i++) hashmap_put(map, (int) next_random(), i),
+                      bench_sink += map->size; free_hashmap(map); arena_free(arena));
+
+        BENCH_MEASURE("vector_push_by_allocator", name, size, size,
+                      struct arena* arena = arena_new(0);
+                      struct vector* vec = vector_new_with_allocator(pick_allocator(a, arena)),
+                      for (int i = 0; i < size; i++) vector_push(vec, i),
+                      bench_sink += vec->size; vector_free(vec); arena_free(arena));
+
+        BENCH_MEASURE("list_add_last_by_allocator", name, size, size,
+                      struct arena* arena = arena_new(0);
+                      struct list* list = newListWithAllocator(pick_allocator(a, arena)),
+                      for (int i = 0; i < size; i++) addLast(list, i),
+                      bench_sink += list->size; freeList(list); arena_free(arena));
+
+        BENCH_MEASURE("pooled_list_add_last_by_allocator", name, size, size,
+                      struct arena* arena = arena_new(0);
+                      struct list* list = newPooledListWithAllocator(pick_allocator(a, arena)),
+                      for (int i = 0; i < size; i++) addLast(list, i),
+                      bench_sink += list->size; freeList(list); arena_free(arena));
+    }
+}
+
+void run_allocator_benchmarks() {
+    bench_raw_patterns();
+
+    const int sizes[] = {1 << 10, 1 << 16, 1 << 20};
+    for (int s = 0; s < 3; s++) {
+        bench_containers(sizes[s]);
+    }
+}
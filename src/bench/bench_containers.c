@@ -0,0 +1,347 @@
+#include "bench.h"
+#include "benchmarks.h"
+#include "../cache/lru_cache.h"
+#include "../hashmap/hashmap.h"
+#include "../linkedlist/intrusivelist.h"
+#include "../linkedlist/linkedlist.h"
+#include "../linkedlist/unrolledlist.h"
+#include "../queue/mpmc_queue.h"
+#include "../vector/vector_deque.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// List, hashmap, queue and cache benchmarks. Variants of one benchmark do the same work
+// so their ns_per_op can be compared directly.
+
+static unsigned int random_state = 88172645u;
+
+static unsigned int next_random() {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static struct list* filled_list(struct list* list, int size) {
+    for (int i = 0; i < size; i++) {
+        addLast(list, i);
+    }
+    return list;
+}
+
+static struct unrolledList* filled_unrolled_list(int size) {
+    struct unrolledList* list = newUnrolledList();
+    for (int i = 0; i < size; i++) {
+        unrolledAddLast(list, i);
+    }
+    return list;
+}
+
+struct bench_item {
+    int value;
+    struct list_link link;
+};
+
+static void bench_list_add(int size) {
+    BENCH_MEASURE("list_add_last", "list", size, size,
+                  struct list* list = newList(),
+                  filled_list(list, size),
+                  bench_sink += list->size; freeList(list));
+
+    BENCH_MEASURE("list_add_last", "pooled_list", size, size,
+                  struct list* list = newPooledList(),
+                  filled_list(list, size),
+                  bench_sink += list->size; freeList(list));
+
+    BENCH_MEASURE("list_add_last", "unrolled_list", size, size,
+                  struct unrolledList* list = NULL,
+                  list = filled_unrolled_list(size),
+                  bench_sink += list->size; freeUnrolledList(list));
+
+    // Includes freeing, which is where the pool's whole page release shows up
+    BENCH_MEASURE("list_churn", "list", size, size * 2LL,
+                  struct list* list = filled_list(newList(), size),
+                  for (int i = 0; i < size; i++) { removeFirst(list); addLast(list, i); },
+                  bench_sink += list->size; freeList(list));
+
+    BENCH_MEASURE("list_churn", "pooled_list", size, size * 2LL,
+                  struct list* list = filled_list(newPooledList(), size),
+                  for (int i = 0; i < size; i++) { removeFirst(list); addLast(list, i); },
+                  bench_sink += list->size; freeList(list));
+}
+
+static void bench_list_traverse(int size) {
+    struct list* list = filled_list(newList(), size);
+    struct unrolledList* unrolled = filled_unrolled_list(size);
+    struct bench_item* items = malloc(sizeof(struct bench_item) * size);
+    struct ilist intrusive;
+    ilist_init(&intrusive);
+    for (int i = 0; i < size; i++) {
+        items[i].value = i;
+        ilist_add_last(&intrusive, &items[i].link);
+    }
+
+    BENCH_MEASURE("list_traverse", "list", size, size, ,
+                  long long sum = 0;
+                  for (struct listIterator it = list_iter_begin(list); list_iter_valid(&it); list_iter_next(&it))
+                      sum += list_iter_get(&it);
+                  bench_sink += sum, );
+
+    BENCH_MEASURE("list_traverse", "unrolled_list", size, size, ,
+                  long long sum = 0;
+                  for (const struct unrolledNode* node = unrolled->head; node != NULL; node = node->next)
+                      for (int i = 0; i < node->count; i++) sum += node->data[i];
+                  bench_sink += sum, );
+
+    BENCH_MEASURE("list_traverse", "intrusive_list", size, size, ,
+                  long long sum = 0;
+                  ilist_for_each(link, &intrusive) sum += container_of(link, struct bench_item, link)->value;
+                  bench_sink += sum, );
+
+    BENCH_MEASURE("list_traverse", "list_to_array", size, size,
+                  int* array = malloc(sizeof(int) * size),
+                  list_to_array(list, array); long long sum = 0; for (int i = 0; i < size; i++) sum += array[i];
+                  bench_sink += sum,
+                  free(array));
+
+    freeList(list);
+    freeUnrolledList(unrolled);
+    free(items);
+}
+
+static void bench_list_positional(int size) {
+    const int operations = 2000;
+    int* indices = malloc(sizeof(int) * operations);
+    for (int i = 0; i < operations; i++) {
+        indices[i] = (int) (next_random() % (unsigned int) size);
+    }
+
+    struct list* list = filled_list(newList(), size);
+    struct list* indexed = filled_list(newList(), size);
+    list_enable_skip_index(indexed);
+    struct unrolledList* unrolled = filled_unrolled_list(size);
+
+    BENCH_MEASURE("list_get_at", "list", size, operations, ,
+                  for (int i = 0; i < operations; i++) bench_sink += getAt(list, indices[i]), );
+    BENCH_MEASURE("list_get_at", "skip_index", size, operations, ,
+                  for (int i = 0; i < operations; i++) bench_sink += getAt(indexed, indices[i]), );
+    BENCH_MEASURE("list_get_at", "unrolled_list", size, operations, ,
+                  for (int i = 0; i < operations; i++) bench_sink += unrolledGetAt(unrolled, indices[i]), );
+
+    // Inserts then removes at the same spots, so the size stays the same across rounds
+    BENCH_MEASURE("list_insert_remove_at", "list", size, operations * 2LL, ,
+                  for (int i = 0; i < operations; i++) { addBefore(list, indices[i], i); removeAt(list, indices[i]); }, );
+    BENCH_MEASURE("list_insert_remove_at", "skip_index", size, operations * 2LL, ,
+                  for (int i = 0; i < operations; i++) { addBefore(indexed, indices[i], i); removeAt(indexed, indices[i]); }, );
+    BENCH_MEASURE("list_insert_remove_at", "unrolled_list", size, operations * 2LL, ,
+                  for (int i = 0; i < operations; i++) {
+                      unrolledAddBefore(unrolled, indices[i], i); unrolledRemoveAt(unrolled, indices[i]);
+                  }, );
+
+    freeList(list);
+    freeList(indexed);
+    freeUnrolledList(unrolled);
+    free(indices);
+}
+
+static void bench_list_sort(int size) {
+    BENCH_MEASURE("list_sort", "list_sort", size, size,
+                  struct list* list = newList(); for (int i = 0; i < size; i++) addLast(list, (int) next_random()),
+                  list_sort(list),
+                  bench_sink += getFirst(list); freeList(list));
+}
+
+void run_list_benchmarks() {
+    const int sizes[] = {1 << 10, 1 << 16};
+
+    for (int s = 0; s < 2; s++) {
+        bench_list_add(sizes[s]);
+        bench_list_traverse(sizes[s]);
+        bench_list_positional(sizes[s]);
+        bench_list_sort(sizes[s]);
+    }
+}
+
+void run_hashmap_benchmarks() {
+    const int sizes[] = {1 << 10, 1 << 16};
+
+    for (int s = 0; s < 2; s++) {
+        const int size = sizes[s];
+        int* keys = malloc(sizeof(int) * size);
+        for (int i = 0; i < size; i++) {
+            keys[i] = (int) next_random();
+        }
+
+        BENCH_MEASURE("hashmap_put", "hashmap", size, size,
+                      struct hashmap* map = new_hashmap(),
+                      for (int i = 0; i < size; i++) hashmap_put(map, keys[i], i),
+                      bench_sink += map->size; free_hashmap(map));
+
+        struct hashmap* map = new_hashmap();
+        for (int i = 0; i < size; i++) {
+            hashmap_put(map, keys[i], i);
+        }
+
+        BENCH_MEASURE("hashmap_get", "hit", size, size, ,
+                      for (int i = 0; i < size; i++) bench_sink += hashmap_get(map, keys[i])->value, );
+        BENCH_MEASURE("hashmap_get", "miss", size, size, ,
+                      for (int i = 0; i < size; i++) bench_sink += hashmap_get(map, keys[i] ^ 0x55555555) != NULL, );
+
+        BENCH_MEASURE("hashmap_remove", "hashmap", size, size,
+                      struct hashmap* filled = new_hashmap(); for (int i = 0; i < size; i++) hashmap_put(filled, keys[i], i),
+                      for (int i = 0; i < size; i++) hashmap_remove(filled, keys[i]),
+                      bench_sink += filled->size; free_hashmap(filled));
+
+        free_hashmap(map);
+        free(keys);
+    }
+}
+
+#define QUEUE_BENCH_THREADS 2
+#define QUEUE_BENCH_VALUES 100000
+
+// The mutex guarded struct list work queue that mpmc_queue is meant to replace
+struct locked_list_queue {
+    pthread_mutex_t lock;
+    struct list* list;
+};
+
+struct queue_bench_args {
+    struct mpmc_queue* queue;
+    struct locked_list_queue* locked;
+};
+
+static void* queue_bench_produce(void* arg) {
+    const struct queue_bench_args* args = arg;
+    for (int i = 0; i < QUEUE_BENCH_VALUES; i++) {
+        if (args->queue != NULL) {
+            while (!mpmc_queue_enqueue(args->queue, i)) {
+                sched_yield();
+            }
+        } else {
+            pthread_mutex_lock(&args->locked->lock);
+            addLast(args->locked->list, i);
+            pthread_mutex_unlock(&args->locked->lock);
+        }
+    }
+    return NULL;
+}
+
+static void* queue_bench_consume(void* arg) {
+    const struct queue_bench_args* args = arg;
+    long long sum = 0;
+    for (int taken = 0; taken < QUEUE_BENCH_VALUES;) {
+        int value = 0;
+        bool got = false;
+        if (args->queue != NULL) {
+            got = mpmc_queue_dequeue(args->queue, &value);
+        } else {
+            pthread_mutex_lock(&args->locked->lock);
+            if (args->locked->list->size > 0) {
+                value = getFirst(args->locked->list);
+                removeFirst(args->locked->list);
+                got = true;
+            }
+            pthread_mutex_unlock(&args->locked->lock);
+        }
+
+        if (got) {
+            sum += value;
+            taken++;
+        } else {
+            sched_yield();
+        }
+    }
+    bench_sink += sum;
+    return NULL;
+}
+
+// Equal numbers of producer and consumer threads passing QUEUE_BENCH_VALUES values each
+static void run_queue_threads(struct queue_bench_args* args) {
+    pthread_t threads[QUEUE_BENCH_THREADS * 2];
+    for (int i = 0; i < QUEUE_BENCH_THREADS; i++) {
+        pthread_create(&threads[i], NULL, queue_bench_produce, args);
+        pthread_create(&threads[QUEUE_BENCH_THREADS + i], NULL, queue_bench_consume, args);
+    }
+    for (int i = 0; i < QUEUE_BENCH_THREADS * 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+void run_queue_benchmarks() {
+    const int size = 1 << 16;
+
+    BENCH_MEASURE("queue_fifo", "vector_deque", size, size * 2LL,
+                  struct vector_deque* deque = vector_deque_new(),
+                  for (int i = 0; i < size; i++) vector_deque_push_back(deque, i);
+                  for (int i = 0; i < size; i++) bench_sink += vector_deque_pop_front(deque).data,
+                  vector_deque_free(deque));
+
+    BENCH_MEASURE("queue_fifo", "list", size, size * 2LL,
+                  struct list* list = newPooledList(),
+                  for (int i = 0; i < size; i++) addLast(list, i);
+                  for (int i = 0; i < size; i++) { bench_sink += getFirst(list); removeFirst(list); },
+                  freeList(list));
+
+    BENCH_MEASURE("queue_fifo", "mpmc_queue", size, size * 2LL,
+                  struct mpmc_queue* queue = mpmc_queue_new(size); int value = 0,
+                  for (int i = 0; i < size; i++) mpmc_queue_enqueue(queue, i);
+                  for (int i = 0; i < size; i++) { mpmc_queue_dequeue(queue, &value); bench_sink += value; },
+                  mpmc_queue_free(queue));
+
+    const long long threaded_operations = QUEUE_BENCH_THREADS * (long long) QUEUE_BENCH_VALUES * 2;
+
+    BENCH_MEASURE("queue_threads", "mpmc_queue", 1024, threaded_operations,
+                  struct queue_bench_args args; args.queue = mpmc_queue_new(1024); args.locked = NULL,
+                  run_queue_threads(&args),
+                  mpmc_queue_free(args.queue));
+
+    BENCH_MEASURE("queue_threads", "locked_list", 1024, threaded_operations,
+                  struct locked_list_queue locked; pthread_mutex_init(&locked.lock, NULL); locked.list = newPooledList();
+                  struct queue_bench_args args; args.queue = NULL; args.locked = &locked,
+                  run_queue_threads(&args),
+                  freeList(locked.list); pthread_mutex_destroy(&locked.lock));
+}
+
+// Keys drawn so that most requests go to a small hot set, like a real cache sees
+static int skewed_key(int key_space) {
+    const unsigned int r = next_random();
+    if (r % 10 < 8) {
+        return (int) ((r >> 8) % (unsigned int) (key_space / 10 + 1));
+    }
+    return (int) ((r >> 8) % (unsigned int) key_space);
+}
+
+void run_cache_benchmarks() {
+    const int capacities[] = {1 << 10, 1 << 14};
+    const int operations = 200000;
+
+    for (int c = 0; c < 2; c++) {
+        const int capacity = capacities[c];
+        int* keys = malloc(sizeof(int) * operations);
+        for (int i = 0; i < operations; i++) {
+            keys[i] = skewed_key(capacity * 4);
+        }
+
+        BENCH_MEASURE("lru_get_or_put", "lru_cache", capacity, operations,
+                      struct lru_cache* cache = lru_cache_new(capacity); int value = 0,
+                      for (int i = 0; i < operations; i++) {
+                          if (!lru_cache_get(cache, keys[i], &value)) lru_cache_put(cache, keys[i], i);
+                          bench_sink += value;
+                      },
+                      lru_cache_free(cache));
+
+        BENCH_MEASURE("lru_get_or_put", "lru_cache_sharded", capacity, operations,
+                      struct lru_cache_sharded* cache = lru_cache_sharded_new(capacity, 8); int value = 0,
+                      for (int i = 0; i < operations; i++) {
+                          if (!lru_cache_sharded_get(cache, keys[i], &value)) lru_cache_sharded_put(cache, keys[i], i);
+                          bench_sink += value;
+                      },
+                      lru_cache_sharded_free(cache));
+
+        free(keys);
+    }
+}
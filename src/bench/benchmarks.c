@@ -0,0 +1,66 @@
+#include "benchmarks.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+struct bench_suite {
+    const char* name;
+    void (*run)();
+};
+
+static const struct bench_suite suites[] = {
+    {"vector", run_vector_benchmarks},
+    {"list", run_list_benchmarks},
+    {"hashmap", run_hashmap_benchmarks},
+    {"queue", run_queue_benchmarks},
+    {"cache", run_cache_benchmarks},
+    {"allocator", run_allocator_benchmarks},
+};
+
+#define SUITE_COUNT ((int) (sizeof(suites) / sizeof(suites[0])))
+
+static void print_usage() {
+    fprintf(stderr, "usage: cstuff bench [--suite <name>] [options]\n  --suite <name>      one of");
+    for (int i = 0; i < SUITE_COUNT; i++) {
+        fprintf(stderr, " %s", suites[i].name);
+    }
+    fprintf(stderr, " (default all)\n");
+    bench_print_usage(stderr);
+}
+
+int run_benchmarks(int argc, char** argv) {
+    const char* suite = NULL;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--suite") == 0 && i + 1 < argc) {
+            suite = argv[i + 1];
+        } else if (strcmp(argv[i], "--help") == 0) {
+            print_usage();
+            return 0;
+        }
+    }
+
+    if (!bench_parse_args(argc, argv)) {
+        print_usage();
+        return 1;
+    }
+
+    bool found = suite == NULL;
+    for (int i = 0; i < SUITE_COUNT; i++) {
+        found = found || strcmp(suites[i].name, suite) == 0;
+    }
+    if (!found) {
+        fprintf(stderr, "bench: no suite called %s\n", suite);
+        print_usage();
+        return 1;
+    }
+
+    bench_begin();
+    for (int i = 0; i < SUITE_COUNT; i++) {
+        if (suite == NULL || strcmp(suites[i].name, suite) == 0) {
+            suites[i].run();
+        }
+    }
+    bench_end();
+    return 0;
+}
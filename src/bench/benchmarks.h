@@ -0,0 +1,11 @@
+#pragma once
+
+// Entry point for `cstuff bench [--suite <name>] [harness options]`, returns the exit code
+int run_benchmarks(int argc, char** argv);
+
+void run_vector_benchmarks();
+void run_list_benchmarks();
+void run_hashmap_benchmarks();
+void run_queue_benchmarks();
+void run_cache_benchmarks();
+void run_allocator_benchmarks();
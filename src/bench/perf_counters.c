@@ -0,0 +1,187 @@
+// NOLINTNEXTLINE
+#define _GNU_SOURCE
+#include "perf_counters.h"
+
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+struct perf_counter_event {
+    const char* name;
+    unsigned int type;
+    unsigned long long config;
+};
+
+#define CACHE_MISS_CONFIG(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct perf_counter_event events[PERF_COUNTER_COUNT] = {
+    [PERF_COUNTER_CYCLES] = {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [PERF_COUNTER_INSTRUCTIONS] = {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [PERF_COUNTER_L1D_MISSES] = {"l1d_misses", PERF_TYPE_HW_CACHE, CACHE_MISS_CONFIG(PERF_COUNT_HW_CACHE_L1D)},
+    [PERF_COUNTER_LLC_MISSES] = {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    [PERF_COUNTER_DTLB_MISSES] = {"dtlb_misses", PERF_TYPE_HW_CACHE, CACHE_MISS_CONFIG(PERF_COUNT_HW_CACHE_DTLB)},
+    [PERF_COUNTER_BRANCH_MISSES] = {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+// What read() returns from a counter opened without PERF_FORMAT_GROUP
+struct perf_read_value {
+    unsigned long long value;
+    unsigned long long time_enabled;
+    unsigned long long time_running;
+};
+
+// What read() of the group leader returns with PERF_FORMAT_GROUP, leader first then the others in open order
+struct perf_read_group {
+    unsigned long long count;
+    unsigned long long time_enabled;
+    unsigned long long time_running;
+    unsigned long long values[PERF_COUNTER_COUNT];
+};
+
+static int open_event(const struct perf_counter_event* event, int group_fd, bool is_group_read, bool inherit) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event->type;
+    attr.config = event->config;
+    attr.disabled = group_fd == -1; // the others follow their leader
+    attr.inherit = inherit;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    if (is_group_read) {
+        attr.read_format |= PERF_FORMAT_GROUP;
+    }
+
+    // This thread and, with inherit, threads it starts afterwards, on whatever CPU they run on
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+// Opens every event the machine allows as one group, so they're always scheduled on the PMU together
+static bool open_group(struct perf_counters* counters, bool is_group_read, bool inherit) {
+    counters->leader = -1;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        const int group_fd = counters->leader >= 0 ? counters->fds[counters->leader] : -1;
+        counters->fds[i] = open_event(&events[i], group_fd, is_group_read, inherit);
+        if (counters->fds[i] >= 0 && counters->leader < 0) {
+            counters->leader = i;
+        }
+    }
+
+    counters->is_group_read = is_group_read;
+    counters->is_thread_only = !inherit;
+    return counters->leader >= 0;
+}
+
+bool perf_counters_open(struct perf_counters* counters) {
+    perf_counters_reset(counters);
+
+    // Older kernels refuse inherit together with PERF_FORMAT_GROUP, then each counter is read on its own,
+    // and if inherit isn't allowed at all the counters only see the thread that opened them
+    if (open_group(counters, true, true)) {
+        return true;
+    }
+    if (open_group(counters, false, true)) {
+        return true;
+    }
+    return open_group(counters, false, false);
+}
+
+void perf_counters_close(struct perf_counters* counters) {
+    // Others first, closing the leader early would turn them into single counters
+    for (int i = PERF_COUNTER_COUNT - 1; i >= 0; i--) {
+        if (counters->fds[i] >= 0) {
+            close(counters->fds[i]);
+            counters->fds[i] = -1;
+        }
+    }
+    counters->leader = -1;
+}
+
+void perf_counters_reset(struct perf_counters* counters) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        counters->values[i] = 0;
+    }
+}
+
+void perf_counters_start(struct perf_counters* counters) {
+    if (counters->leader < 0) {
+        return;
+    }
+
+    ioctl(counters->fds[counters->leader], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters->fds[counters->leader], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+// Scales a count up when the kernel had to multiplex the group and it only ran for part of the time
+static double scale_value(unsigned long long value, unsigned long long time_enabled,
+                          unsigned long long time_running) {
+    if (time_running > 0 && time_running < time_enabled) {
+        return (double) value * (double) time_enabled / (double) time_running;
+    }
+    return (double) value;
+}
+
+void perf_counters_stop(struct perf_counters* counters) {
+    if (counters->leader < 0) {
+        return;
+    }
+
+    // The whole group stops at once, so reading one counter isn't counted by the others
+    ioctl(counters->fds[counters->leader], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    if (counters->is_group_read) {
+        struct perf_read_group group;
+        if (read(counters->fds[counters->leader], &group, sizeof(group)) < (ssize_t) (3 * sizeof(unsigned long long))) {
+            return;
+        }
+
+        unsigned long long next = 0;
+        for (int i = 0; i < PERF_COUNTER_COUNT && next < group.count; i++) {
+            if (counters->fds[i] >= 0) {
+                counters->values[i] += scale_value(group.values[next++], group.time_enabled, group.time_running);
+            }
+        }
+        return;
+    }
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        struct perf_read_value read_value;
+        if (counters->fds[i] < 0 || read(counters->fds[i], &read_value, sizeof(read_value)) != sizeof(read_value)) {
+            continue;
+        }
+        counters->values[i] += scale_value(read_value.value, read_value.time_enabled, read_value.time_running);
+    }
+}
+
+bool perf_counter_is_available(const struct perf_counters* counters, enum perf_counter counter) {
+    return counters->fds[counter] >= 0;
+}
+
+const char* perf_counter_name(enum perf_counter counter) {
+    return events[counter].name;
+}
+
+double perf_counter_per_op(const struct perf_counters* counters, enum perf_counter counter, long long operations) {
+    if (!perf_counter_is_available(counters, counter)) {
+        return -1;
+    }
+
+    return counters->values[counter] / (double) (operations > 0 ? operations : 1);
+}
+
+void perf_counters_print(const struct perf_counters* counters, long long operations, FILE* stream) {
+    if (counters->is_thread_only) {
+        fprintf(stream, "counting the calling thread only\n");
+    }
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (perf_counter_is_available(counters, i)) {
+            fprintf(stream, "%s: %.3f per op\n", perf_counter_name(i), perf_counter_per_op(counters, i, operations));
+        } else {
+            fprintf(stream, "%s: unavailable\n", perf_counter_name(i));
+        }
+    }
+}
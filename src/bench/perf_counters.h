@@ -0,0 +1,53 @@
+#pragma once
+#include <stdbool.h>
+#include <stdio.h>
+
+// Hardware performance counters through perf_event_open, in user mode, for the calling thread
+// and the threads it starts after perf_counters_open. The counters are opened as one group so
+// they're always scheduled together. Where the kernel doesn't let counters be inherited,
+// is_thread_only is set and worker threads aren't counted. Counters the CPU, kernel or
+// perf_event_paranoid don't allow are just left unavailable, so the same code runs everywhere
+// and reports what it can.
+//
+//     struct perf_counters counters;
+//     perf_counters_open(&counters);
+//     perf_counters_start(&counters);
+//     ... hot region ...
+//     perf_counters_stop(&counters);
+//     perf_counters_print(&counters, operations, stderr);
+//     perf_counters_close(&counters);
+
+enum perf_counter {
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_L1D_MISSES,
+    PERF_COUNTER_LLC_MISSES,
+    PERF_COUNTER_DTLB_MISSES,
+    PERF_COUNTER_BRANCH_MISSES,
+    PERF_COUNTER_COUNT,
+};
+
+struct perf_counters {
+    int fds[PERF_COUNTER_COUNT]; // -1 when unavailable
+    // Totals over every start/stop pair since the last reset, scaled up when the kernel had
+    // to multiplex the counter and it only ran for part of the time
+    double values[PERF_COUNTER_COUNT];
+    int leader; // index of the group leader in fds, -1 when nothing could be opened
+    bool is_group_read; // one read of the leader returns the whole group
+    bool is_thread_only; // threads started later aren't counted
+};
+
+// False if no counter at all could be opened
+bool perf_counters_open(struct perf_counters* counters);
+void perf_counters_close(struct perf_counters* counters);
+
+void perf_counters_reset(struct perf_counters* counters);
+void perf_counters_start(struct perf_counters* counters);
+// Adds what was counted since perf_counters_start to values
+void perf_counters_stop(struct perf_counters* counters);
+
+bool perf_counter_is_available(const struct perf_counters* counters, enum perf_counter counter);
+const char* perf_counter_name(enum perf_counter counter);
+// value / operations, or -1 if the counter is unavailable
+double perf_counter_per_op(const struct perf_counters* counters, enum perf_counter counter, long long operations);
+void perf_counters_print(const struct perf_counters* counters, long long operations, FILE* stream);
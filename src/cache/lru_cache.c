@@ -0,0 +1,187 @@
+#include "lru_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+struct lru_cache* lru_cache_new(int capacity) {
+    if (capacity < 1) {
+        capacity = 1;
+    }
+
+    struct lru_cache* cache = malloc(sizeof(struct lru_cache));
+    cache->capacity = capacity;
+    cache->slot_of_key = new_hashmap();
+    cache->recency = newPooledList();
+    cache->slots = malloc(sizeof(struct lru_cache_slot) * capacity);
+    cache->used_slots = 0;
+    cache->free_slots = malloc(sizeof(int) * capacity);
+    cache->free_slot_count = 0;
+    cache->stats = (struct lru_cache_stats) {0, 0, 0};
+    return cache;
+}
+
+void lru_cache_free(struct lru_cache* cache) {
+    free_hashmap(cache->slot_of_key);
+    freeList(cache->recency);
+    free(cache->slots);
+    free(cache->free_slots);
+    free(cache);
+}
+
+static struct lru_cache_slot* find_slot(const struct lru_cache* cache, int key) {
+    const struct hashmap_entry* entry = hashmap_get(cache->slot_of_key, key);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    return &cache->slots[entry->value];
+}
+
+bool lru_cache_get(struct lru_cache* cache, int key, int* out) {
+    struct lru_cache_slot* slot = find_slot(cache, key);
+    if (slot == NULL) {
+        cache->stats.misses++;
+        return false;
+    }
+
+    cache->stats.hits++;
+    list_move_to_front(cache->recency, slot->recency_entry);
+    *out = slot->value;
+    return true;
+}
+
+// A slot nobody is using, evicting the least recently used key when they're all taken
+static int take_slot(struct lru_cache* cache) {
+    if (cache->free_slot_count > 0) {
+        return cache->free_slots[--cache->free_slot_count];
+    }
+
+    if (cache->used_slots < cache->capacity) {
+        return cache->used_slots++;
+    }
+
+    struct listEntry* oldest = cache->recency->tail;
+    const int slot_index = oldest->data;
+    hashmap_remove(cache->slot_of_key, cache->slots[slot_index].key);
+    list_remove_node(cache->recency, oldest);
+    cache->stats.evictions++;
+    return slot_index;
+}
+
+void lru_cache_put(struct lru_cache* cache, int key, int value) {
+    struct lru_cache_slot* existing = find_slot(cache, key);
+    if (existing != NULL) {
+        existing->value = value;
+        list_move_to_front(cache->recency, existing->recency_entry);
+        return;
+    }
+
+    const int slot_index = take_slot(cache);
+    struct lru_cache_slot* slot = &cache->slots[slot_index];
+    slot->key = key;
+    slot->value = value;
+
+    addFirst(cache->recency, slot_index);
+    slot->recency_entry = cache->recency->head;
+    hashmap_put(cache->slot_of_key, key, slot_index);
+}
+
+bool lru_cache_remove(struct lru_cache* cache, int key) {
+    const struct hashmap_entry* entry = hashmap_get(cache->slot_of_key, key);
+    if (entry == NULL) {
+        return false;
+    }
+
+    const int slot_index = entry->value;
+    list_remove_node(cache->recency, cache->slots[slot_index].recency_entry);
+    hashmap_remove(cache->slot_of_key, key);
+    cache->free_slots[cache->free_slot_count++] = slot_index;
+    return true;
+}
+
+int lru_cache_size(const struct lru_cache* cache) {
+    return cache->recency->size;
+}
+
+struct lru_cache_sharded* lru_cache_sharded_new(int capacity, int shard_count) {
+    if (capacity < 1) {
+        capacity = 1;
+    }
+    // Every shard holds at least one entry, so there are never more shards than capacity
+    if (shard_count > capacity) {
+        shard_count = capacity;
+    }
+    if (shard_count < 1) {
+        shard_count = 1;
+    }
+
+    struct lru_cache_sharded* cache = malloc(sizeof(struct lru_cache_sharded));
+    cache->shard_count = shard_count;
+    cache->shards = aligned_alloc(64, sizeof(struct lru_cache_shard) * shard_count);
+    if (cache->shards == NULL) {
+        printf("failed to malloc");
+        exit(1);
+    }
+
+    for (int i = 0; i < shard_count; i++) {
+        // The first shards take the remainder
+        const int shard_capacity = capacity / shard_count + (i < capacity % shard_count ? 1 : 0);
+        pthread_mutex_init(&cache->shards[i].lock, NULL);
+        cache->shards[i].cache = lru_cache_new(shard_capacity);
+    }
+    return cache;
+}
+
+void lru_cache_sharded_free(struct lru_cache_sharded* cache) {
+    for (int i = 0; i < cache->shard_count; i++) {
+        pthread_mutex_destroy(&cache->shards[i].lock);
+        lru_cache_free(cache->shards[i].cache);
+    }
+    free(cache->shards);
+    free(cache);
+}
+
+// Mixes the key first, so runs of neighbouring keys don't all land in the same few shards
+static struct lru_cache_shard* get_shard(const struct lru_cache_sharded* cache, int key) {
+    unsigned int hash = (unsigned int) key;
+    hash ^= hash >> 16;
+    hash *= 0x7feb352du;
+    hash ^= hash >> 15;
+    return &cache->shards[hash % (unsigned int) cache->shard_count];
+}
+
+bool lru_cache_sharded_get(struct lru_cache_sharded* cache, int key, int* out) {
+    struct lru_cache_shard* shard = get_shard(cache, key);
+    pthread_mutex_lock(&shard->lock);
+    const bool found = lru_cache_get(shard->cache, key, out);
+    pthread_mutex_unlock(&shard->lock);
+    return found;
+}
+
+void lru_cache_sharded_put(struct lru_cache_sharded* cache, int key, int value) {
+    struct lru_cache_shard* shard = get_shard(cache, key);
+    pthread_mutex_lock(&shard->lock);
+    lru_cache_put(shard->cache, key, value);
+    pthread_mutex_unlock(&shard->lock);
+}
+
+bool lru_cache_sharded_remove(struct lru_cache_sharded* cache, int key) {
+    struct lru_cache_shard* shard = get_shard(cache, key);
+    pthread_mutex_lock(&shard->lock);
+    const bool removed = lru_cache_remove(shard->cache, key);
+    pthread_mutex_unlock(&shard->lock);
+    return removed;
+}
+
+struct lru_cache_stats lru_cache_sharded_stats(struct lru_cache_sharded* cache) {
+    struct lru_cache_stats total = {0, 0, 0};
+    for (int i = 0; i < cache->shard_count; i++) {
+        struct lru_cache_shard* shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        total.hits += shard->cache->stats.hits;
+        total.misses += shard->cache->stats.misses;
+        total.evictions += shard->cache->stats.evictions;
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include "../hashmap/hashmap.h"
+#include "../linkedlist/linkedlist.h"
+
+// Fixed capacity int -> int cache that evicts the least recently used key.
+// The hashmap maps a key to its slot, every slot remembers its entry in the recency list
+// (most recent at the head), so a hit moves it to the front and an eviction takes the tail,
+// both without searching the list.
+
+struct lru_cache_stats {
+    long long hits;
+    long long misses;
+    long long evictions;
+};
+
+struct lru_cache_slot {
+    int key;
+    int value;
+    struct listEntry* recency_entry; // its data is the slot's index
+};
+
+struct lru_cache {
+    int capacity;
+    struct hashmap* slot_of_key;
+    struct list* recency; // pooled, so hits and evictions never reach malloc
+    struct lru_cache_slot* slots;
+    int used_slots; // slots below this have been handed out at some point
+    int* free_slots; // stack of slots given back by lru_cache_remove
+    int free_slot_count;
+    struct lru_cache_stats stats;
+};
+
+struct lru_cache* lru_cache_new(int capacity);
+void lru_cache_free(struct lru_cache* cache);
+
+// False on a miss, out is left alone then
+bool lru_cache_get(struct lru_cache* cache, int key, int* out);
+// Evicts the least recently used key first if the cache is full and key isn't in it
+void lru_cache_put(struct lru_cache* cache, int key, int value);
+// False if key wasn't cached
+bool lru_cache_remove(struct lru_cache* cache, int key);
+int lru_cache_size(const struct lru_cache* cache);
+
+// Thread safe version split into shards by key, each an lru_cache with its own lock, so threads
+// working on different keys rarely wait on each other. Recency is per shard, not global.
+
+struct lru_cache_shard {
+    alignas(64) pthread_mutex_t lock;
+    struct lru_cache* cache;
+};
+
+struct lru_cache_sharded {
+    int shard_count;
+    struct lru_cache_shard* shards;
+};
+
+// capacity is split evenly between the shards. shard_count is cut down to capacity when it's bigger,
+// so the total capacity stays what was asked for (at least 1)
+struct lru_cache_sharded* lru_cache_sharded_new(int capacity, int shard_count);
+void lru_cache_sharded_free(struct lru_cache_sharded* cache);
+
+bool lru_cache_sharded_get(struct lru_cache_sharded* cache, int key, int* out);
+void lru_cache_sharded_put(struct lru_cache_sharded* cache, int key, int value);
+bool lru_cache_sharded_remove(struct lru_cache_sharded* cache, int key);
+
+// Counters added up over all shards
+struct lru_cache_stats lru_cache_sharded_stats(struct lru_cache_sharded* cache);
\ No newline at end of file
@@ -0,0 +1,129 @@
+// ReSharper disable CppLocalVariableMayBeConst
+#pragma once
+#include "lru_cache.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#define LRU_TEST_THREADS 4
+#define LRU_TEST_OPERATIONS 50000
+
+struct lru_test_args {
+    struct lru_cache_sharded* cache;
+    int thread_index;
+};
+
+static void* lru_test_worker(void* arg) {
+    const struct lru_test_args* args = arg;
+    unsigned int seed = args->thread_index + 1;
+
+    for (int i = 0; i < LRU_TEST_OPERATIONS; i++) {
+        const int key = rand_r(&seed) % 2000;
+        int value;
+        if (lru_cache_sharded_get(args->cache, key, &value)) {
+            assert(value == key * 3); // values only ever depend on the key
+        } else {
+            lru_cache_sharded_put(args->cache, key, key * 3);
+        }
+    }
+    return NULL;
+}
+
+void testLruCache() {
+    printf("=== LRU Cache Test ===\n\n");
+
+    // Test 1: Hits, misses and updates
+    printf("Test 1: Getting and putting\n");
+    struct lru_cache* cache = lru_cache_new(3);
+    int value = -1;
+    assert(!lru_cache_get(cache, 1, &value));
+    assert(value == -1);
+
+    lru_cache_put(cache, 1, 10);
+    lru_cache_put(cache, 2, 20);
+    lru_cache_put(cache, 1, 11);
+    assert(lru_cache_size(cache) == 2);
+    assert(lru_cache_get(cache, 1, &value) && value == 11);
+    assert(lru_cache_get(cache, 2, &value) && value == 20);
+    assert(cache->stats.hits == 2);
+    assert(cache->stats.misses == 1);
+    printf("✓ Getting and putting working correctly\n\n");
+
+    // Test 2: The least recently used key goes first
+    printf("Test 2: Evicting\n");
+    lru_cache_put(cache, 3, 30); // 3, 2, 1
+    assert(lru_cache_get(cache, 1, &value)); // 1, 3, 2
+    lru_cache_put(cache, 4, 40); // 2 is evicted
+    assert(cache->stats.evictions == 1);
+    assert(lru_cache_size(cache) == 3);
+    assert(!lru_cache_get(cache, 2, &value));
+    assert(lru_cache_get(cache, 3, &value) && value == 30); // 3, 4, 1
+
+    lru_cache_put(cache, 5, 50); // 1 is evicted
+    assert(!lru_cache_get(cache, 1, &value));
+    assert(lru_cache_get(cache, 4, &value) && value == 40);
+    assert(cache->stats.evictions == 2);
+
+    // Removed keys free their slot without evicting anything
+    assert(lru_cache_remove(cache, 3));
+    assert(!lru_cache_remove(cache, 3));
+    lru_cache_put(cache, 6, 60);
+    assert(cache->stats.evictions == 2);
+    assert(lru_cache_get(cache, 5, &value) && value == 50);
+    assert(lru_cache_get(cache, 6, &value) && value == 60);
+    lru_cache_free(cache);
+
+    // Lots of churn through a small cache
+    cache = lru_cache_new(100);
+    for (int i = 0; i < 100000; i++) {
+        lru_cache_put(cache, i, i);
+        assert(lru_cache_get(cache, i, &value) && value == i);
+    }
+    assert(lru_cache_size(cache) == 100);
+    assert(cache->stats.evictions == 100000 - 100);
+    assert(lru_cache_get(cache, 99900, &value));
+    assert(!lru_cache_get(cache, 99899, &value));
+    lru_cache_free(cache);
+    printf("✓ Evicting working correctly\n\n");
+
+    // Test 3: Sharded cache from several threads
+    printf("Test 3: Sharded cache\n");
+    struct lru_cache_sharded* sharded = lru_cache_sharded_new(1000, 8);
+    int total_capacity = 0;
+    for (int i = 0; i < 8; i++) {
+        total_capacity += sharded->shards[i].cache->capacity;
+    }
+    assert(total_capacity == 1000);
+
+    // More shards than capacity would leave some empty, there are fewer shards instead
+    struct lru_cache_sharded* small = lru_cache_sharded_new(3, 8);
+    assert(small->shard_count == 3);
+    for (int i = 0; i < small->shard_count; i++) {
+        assert(small->shards[i].cache->capacity == 1);
+    }
+    lru_cache_sharded_free(small);
+
+    pthread_t threads[LRU_TEST_THREADS];
+    struct lru_test_args args[LRU_TEST_THREADS];
+    for (int i = 0; i < LRU_TEST_THREADS; i++) {
+        args[i] = (struct lru_test_args) {sharded, i};
+        pthread_create(&threads[i], NULL, lru_test_worker, &args[i]);
+    }
+    for (int i = 0; i < LRU_TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    const struct lru_cache_stats stats = lru_cache_sharded_stats(sharded);
+    assert(stats.hits + stats.misses == LRU_TEST_THREADS * LRU_TEST_OPERATIONS);
+    assert(stats.hits > 0 && stats.evictions > 0);
+
+    lru_cache_sharded_put(sharded, -5, 7);
+    assert(lru_cache_sharded_get(sharded, -5, &value) && value == 7);
+    assert(lru_cache_sharded_remove(sharded, -5));
+    assert(!lru_cache_sharded_get(sharded, -5, &value));
+    lru_cache_sharded_free(sharded);
+    printf("✓ Sharded cache working correctly\n\n");
+
+    printf("✓ All LRU cache tests passed!\n");
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "hashmap.h"
+#include "../allocation/allocator.h"
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -10,10 +11,15 @@
 #define MINIMUM_BUCKET_COUNT 4
 
 struct hashmap* new_hashmap() {
-    struct hashmap* map = malloc(sizeof(struct hashmap));
+    return new_hashmap_with_allocator(&allocator_libc);
+}
+
+struct hashmap* new_hashmap_with_allocator(const struct allocator* allocator) {
+    struct hashmap* map = allocator_malloc(allocator, sizeof(struct hashmap));
     map->size = 0;
+    map->allocator = allocator;
     map->bucket_size = MINIMUM_BUCKET_COUNT;
-    map->bucket_array = malloc(map->bucket_size * sizeof(struct hashmap_bucket));
+    map->bucket_array = allocator_malloc(allocator, map->bucket_size * sizeof(struct hashmap_bucket));
 
     for (int i = 0; i < map->bucket_size; i++) {
         struct hashmap_bucket* bucket = &map->bucket_array[i];
@@ -26,11 +32,13 @@ struct hashmap* new_hashmap() {
 }
 
 void free_hashmap(struct hashmap* map) {
+    const struct allocator* allocator = map->allocator;
     for (int i = 0; i < map->bucket_size; i++) {
-        free(map->bucket_array[i].array);
+        const struct hashmap_bucket* bucket = &map->bucket_array[i];
+        allocator_free(allocator, bucket->array, bucket->array_size * sizeof(struct hashmap_entry));
     }
-    free(map->bucket_array);
-    free(map);
+    allocator_free(allocator, map->bucket_array, map->bucket_size * sizeof(struct hashmap_bucket));
+    allocator_free(allocator, map, sizeof(struct hashmap));
 }
 
 static unsigned int get_hash_index(const struct hashmap* map, int key) {
@@ -49,13 +57,12 @@ static double get_load_factor(const struct hashmap* map) {
     return a / b;
 }
 
-static void hashmap_bucket_push(struct hashmap_bucket* bucket, const struct hashmap_entry* entry) {
-    if (bucket->array != NULL) {
-        bucket->array = realloc(bucket->array, ++bucket->array_size * sizeof(struct hashmap_entry));
-    } else {
-        bucket->array_size++;
-        bucket->array = malloc(sizeof(struct hashmap_entry));
-    }
+static void hashmap_bucket_push(const struct hashmap* map, struct hashmap_bucket* bucket,
+                                const struct hashmap_entry* entry) {
+    const size_t old_size = bucket->array_size * sizeof(struct hashmap_entry);
+    bucket->array_size++;
+    bucket->array = allocator_realloc(map->allocator, bucket->array, old_size,
+                                      bucket->array_size * sizeof(struct hashmap_entry));
 
     bucket->array[bucket->array_size - 1] = *entry;
 }
@@ -72,7 +79,7 @@ static void try_resizing(struct hashmap* map) {
     struct hashmap_bucket* old_bucket_array = map->bucket_array;
 
     map->bucket_size = new_bucket_size;
-    map->bucket_array = malloc(map->bucket_size * sizeof(struct hashmap_bucket));
+    map->bucket_array = allocator_malloc(map->allocator, map->bucket_size * sizeof(struct hashmap_bucket));
 
     for (int i = 0; i < map->bucket_size; i++) {
         struct hashmap_bucket* bucket = &map->bucket_array[i];
@@ -86,13 +93,13 @@ static void try_resizing(struct hashmap* map) {
         for (int j = 0; j < old_bucket->array_size; j++) {
             const struct hashmap_entry* entry = &old_bucket->array[j];
             struct hashmap_bucket* bucket = &map->bucket_array[get_hash_index(map, entry->key)];
-            hashmap_bucket_push(bucket, entry);
+            hashmap_bucket_push(map, bucket, entry);
         }
 
-        free(old_bucket->array);
+        allocator_free(map->allocator, old_bucket->array, old_bucket->array_size * sizeof(struct hashmap_entry));
     }
 
-    free(old_bucket_array);
+    allocator_free(map->allocator, old_bucket_array, old_bucket_array_size * sizeof(struct hashmap_bucket));
 }
 
 void hashmap_put(struct hashmap* map, int key, int value) {
@@ -105,7 +112,7 @@ void hashmap_put(struct hashmap* map, int key, int value) {
     const unsigned int hash_index = get_hash_index(map, key);
     struct hashmap_bucket* bucket = &map->bucket_array[hash_index];
 
-    hashmap_bucket_push(bucket, &(struct hashmap_entry) {key, value});
+    hashmap_bucket_push(map, bucket, &(struct hashmap_entry) {key, value});
     map->size++;
     try_resizing(map);
 }
@@ -139,7 +146,7 @@ void hashmap_remove(struct hashmap* map, int key) {
     if (bucket->array_size == 1) {
         array = NULL;
     } else {
-        array = malloc(sizeof(struct hashmap_entry) * (bucket->array_size - 1));
+        array = allocator_malloc(map->allocator, sizeof(struct hashmap_entry) * (bucket->array_size - 1));
     }
 
     for (int i = 0; i < bucket->array_size; i++) {
@@ -157,9 +164,9 @@ void hashmap_remove(struct hashmap* map, int key) {
     }
 
     if (!did_find_key) {
-        free(array);
+        allocator_free(map->allocator, array, sizeof(struct hashmap_entry) * (bucket->array_size - 1));
     } else {
-        free(bucket->array);
+        allocator_free(map->allocator, bucket->array, sizeof(struct hashmap_entry) * bucket->array_size);
         map->size--;
         bucket->array_size--;
         bucket->array = array;
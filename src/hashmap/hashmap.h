@@ -1,9 +1,12 @@
 #pragma once
 
+struct allocator;
+
 struct hashmap {
     int size;
     int bucket_size;
     struct hashmap_bucket* bucket_array;
+    const struct allocator* allocator; // the map itself, the bucket array and every bucket's entries come from here
 };
 
 struct hashmap_bucket {
@@ -18,6 +21,8 @@ struct hashmap_entry {
 };
 
 struct hashmap* new_hashmap();
+// allocator has to outlive the map
+struct hashmap* new_hashmap_with_allocator(const struct allocator* allocator);
 void free_hashmap(struct hashmap* map);
 
 void hashmap_put(struct hashmap* map, int key, int value);
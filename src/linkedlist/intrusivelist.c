@@ -0,0 +1,208 @@
+#include "intrusivelist.h"
+
+void ilist_init(struct ilist* list) {
+    list->size = 0;
+    list->head = NULL;
+    list->tail = NULL;
+}
+
+static bool isValidIndex(const struct ilist* list, int index) {
+    if (index < 0 || index >= list->size) {
+        return false;
+    }
+
+    return true;
+}
+
+static struct list_link* getLinkAt(const struct ilist* list, int index) {
+    // Walk from whichever end is closer
+    if (index < list->size / 2) {
+        struct list_link* link = list->head;
+        for (int linkIndex = 0; linkIndex != index; linkIndex++) {
+            link = link->next;
+        }
+        return link;
+    }
+
+    struct list_link* link = list->tail;
+    for (int linkIndex = list->size - 1; linkIndex != index; linkIndex--) {
+        link = link->prev;
+    }
+    return link;
+}
+
+void ilist_insert_before(struct ilist* list, struct list_link* position, struct list_link* link) {
+    link->next = position;
+    link->prev = position->prev;
+
+    if (position->prev == NULL) { // if prev is null, means this head
+        list->head = link;
+    } else {
+        position->prev->next = link;
+    }
+    position->prev = link;
+
+    list->size++;
+}
+
+void ilist_insert_after(struct ilist* list, struct list_link* position, struct list_link* link) {
+    link->prev = position;
+    link->next = position->next;
+
+    if (position->next == NULL) { // if next is null, means this tail
+        list->tail = link;
+    } else {
+        position->next->prev = link;
+    }
+    position->next = link;
+
+    list->size++;
+}
+
+void ilist_add_first(struct ilist* list, struct list_link* link) {
+    if (list->head == NULL) {
+        link->prev = NULL;
+        link->next = NULL;
+        list->head = link;
+        list->tail = link;
+        list->size++;
+        return;
+    }
+
+    ilist_insert_before(list, list->head, link);
+}
+
+void ilist_add_before(struct ilist* list, int index, struct list_link* link) {
+    if (!isValidIndex(list, index)) {
+        return;
+    }
+
+    ilist_insert_before(list, getLinkAt(list, index), link);
+}
+
+void ilist_add_after(struct ilist* list, int index, struct list_link* link) {
+    if (!isValidIndex(list, index)) {
+        return;
+    }
+
+    ilist_insert_after(list, getLinkAt(list, index), link);
+}
+
+void ilist_add_last(struct ilist* list, struct list_link* link) {
+    if (list->tail == NULL) {
+        ilist_add_first(list, link);
+        return;
+    }
+
+    ilist_insert_after(list, list->tail, link);
+}
+
+void ilist_unlink(struct ilist* list, struct list_link* link) {
+    if (link->prev == NULL) { // if prev is null, it's the head
+        list->head = link->next;
+    } else {
+        link->prev->next = link->next;
+    }
+
+    if (link->next == NULL) { // if next is null, it's the tail
+        list->tail = link->prev;
+    } else {
+        link->next->prev = link->prev;
+    }
+
+    link->prev = NULL;
+    link->next = NULL;
+    list->size--;
+}
+
+struct list_link* ilist_remove_first(struct ilist* list) {
+    struct list_link* head = list->head;
+    if (head != NULL) {
+        ilist_unlink(list, head);
+    }
+    return head;
+}
+
+struct list_link* ilist_remove_at(struct ilist* list, int index) {
+    if (!isValidIndex(list, index)) {
+        return NULL;
+    }
+
+    struct list_link* link = getLinkAt(list, index);
+    ilist_unlink(list, link);
+    return link;
+}
+
+struct list_link* ilist_remove_last(struct ilist* list) {
+    struct list_link* tail = list->tail;
+    if (tail != NULL) {
+        ilist_unlink(list, tail);
+    }
+    return tail;
+}
+
+struct list_link* ilist_get_first(const struct ilist* list) {
+    return list->head;
+}
+
+struct list_link* ilist_get_at(const struct ilist* list, int index) {
+    if (!isValidIndex(list, index)) {
+        return NULL;
+    }
+
+    return getLinkAt(list, index);
+}
+
+struct list_link* ilist_get_last(const struct ilist* list) {
+    return list->tail;
+}
+
+int ilist_find_index(const struct ilist* list, const struct list_link* link) {
+    int index = 0;
+
+    for (const struct list_link* curr = list->head; curr != NULL; curr = curr->next) {
+        if (curr == link) {
+            return index;
+        }
+        index++;
+    }
+
+    return -1;
+}
+
+bool ilist_contains(const struct ilist* list, const struct list_link* link) {
+    return ilist_find_index(list, link) != -1;
+}
+
+void ilist_reverse(struct ilist* list) {
+    if (list->size < 2) {
+        return;
+    }
+
+    struct list_link* temp;
+    struct list_link* curr = list->head;
+
+    while (curr != NULL) {
+        temp = curr->next;
+        curr->next = curr->prev;
+        curr->prev = temp;
+        curr = temp;
+    }
+
+    temp = list->head;
+    list->head = list->tail;
+    list->tail = temp;
+}
+
+void ilist_clear(struct ilist* list) {
+    struct list_link* link = list->head;
+
+    while (link != NULL) {
+        struct list_link* next = link->next;
+        link->prev = NULL;
+        link->next = NULL;
+        link = next;
+    }
+
+    ilist_init(list);
+}
\ No newline at end of file
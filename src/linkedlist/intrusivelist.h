@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Intrusive version of struct list, the links live inside the caller's own structs, eg.
+//
+//     struct cacheEntry {
+//         int key;
+//         struct list_link link;
+//     };
+//
+// so putting an object in a list needs no allocation, and container_of gets back from
+// a link to the object holding it. An object can be in several lists with several links.
+// The list never allocates or frees anything, the objects belong to the caller.
+
+#define container_of(pointer, type, member) ((type*) ((char*) (pointer) - offsetof(type, member)))
+
+struct list_link {
+    struct list_link* prev;
+    struct list_link* next;
+};
+
+struct ilist {
+    int size;
+    struct list_link* head;
+    struct list_link* tail;
+};
+
+// for (struct list_link* link = list->head; link != NULL; link = link->next), as a macro
+#define ilist_for_each(link, list) for (struct list_link* link = (list)->head; link != NULL; link = link->next)
+
+void ilist_init(struct ilist* list);
+
+void ilist_add_first(struct ilist* list, struct list_link* link);
+void ilist_add_before(struct ilist* list, int index, struct list_link* link);
+void ilist_add_after(struct ilist* list, int index, struct list_link* link);
+void ilist_add_last(struct ilist* list, struct list_link* link);
+// O(1) when the neighbour's link is already at hand
+void ilist_insert_before(struct ilist* list, struct list_link* position, struct list_link* link);
+void ilist_insert_after(struct ilist* list, struct list_link* position, struct list_link* link);
+
+// The remove functions return the link taken out, or NULL if there was nothing to remove
+struct list_link* ilist_remove_first(struct ilist* list);
+struct list_link* ilist_remove_at(struct ilist* list, int index);
+struct list_link* ilist_remove_last(struct ilist* list);
+// O(1), link must be in list
+void ilist_unlink(struct ilist* list, struct list_link* link);
+
+struct list_link* ilist_get_first(const struct ilist* list);
+struct list_link* ilist_get_at(const struct ilist* list, int index);
+struct list_link* ilist_get_last(const struct ilist* list);
+
+int ilist_find_index(const struct ilist* list, const struct list_link* link);
+bool ilist_contains(const struct ilist* list, const struct list_link* link);
+void ilist_reverse(struct ilist* list);
+// Unlinks everything, the objects themselves are left alone
+void ilist_clear(struct ilist* list);
\ No newline at end of file
@@ -0,0 +1,91 @@
+// ReSharper disable CppLocalVariableMayBeConst
+#pragma once
+#include "intrusivelist.h"
+#include <stdio.h>
+#include <assert.h>
+
+struct intrusiveTestItem {
+    int value;
+    struct list_link byValue;
+    struct list_link recent; // the same item in a second list
+};
+
+static int itemValue(const struct list_link* link) {
+    return container_of(link, struct intrusiveTestItem, byValue)->value;
+}
+
+void testIntrusiveList() {
+    printf("=== Intrusive List Test ===\n\n");
+
+    struct intrusiveTestItem items[10];
+    for (int i = 0; i < 10; i++) {
+        items[i].value = i;
+    }
+
+    // Test 1: Adding links and getting the items back
+    printf("Test 1: Adding items\n");
+    struct ilist list;
+    ilist_init(&list);
+    assert(list.size == 0);
+    assert(ilist_get_first(&list) == NULL);
+
+    for (int i = 1; i < 9; i++) {
+        ilist_add_last(&list, &items[i].byValue);
+    }
+    ilist_add_first(&list, &items[0].byValue);
+    ilist_add_after(&list, 8, &items[9].byValue);
+    assert(list.size == 10);
+
+    int expected = 0;
+    ilist_for_each(link, &list) {
+        assert(itemValue(link) == expected);
+        expected++;
+    }
+    assert(itemValue(ilist_get_at(&list, 7)) == 7);
+    assert(ilist_get_last(&list) == &items[9].byValue);
+    assert(ilist_find_index(&list, &items[4].byValue) == 4);
+    printf("✓ Adding items working correctly\n\n");
+
+    // Test 2: Unlinking given the item, no search
+    printf("Test 2: Unlinking items\n");
+    ilist_unlink(&list, &items[4].byValue);
+    ilist_unlink(&list, &items[0].byValue);
+    ilist_unlink(&list, &items[9].byValue);
+    assert(list.size == 7);
+    assert(!ilist_contains(&list, &items[4].byValue));
+    assert(itemValue(ilist_get_first(&list)) == 1);
+    assert(itemValue(ilist_get_last(&list)) == 8);
+    assert(itemValue(ilist_get_at(&list, 3)) == 5);
+
+    ilist_insert_before(&list, &items[5].byValue, &items[4].byValue);
+    assert(itemValue(ilist_get_at(&list, 3)) == 4);
+    assert(itemValue(ilist_remove_at(&list, 3)) == 4);
+    assert(itemValue(ilist_remove_first(&list)) == 1);
+    assert(itemValue(ilist_remove_last(&list)) == 8);
+    assert(list.size == 5);
+
+    ilist_reverse(&list);
+    assert(itemValue(ilist_get_first(&list)) == 7);
+    assert(itemValue(ilist_get_last(&list)) == 2);
+    printf("✓ Unlinking items working correctly\n\n");
+
+    // Test 3: One item in two lists at once
+    printf("Test 3: Item in two lists\n");
+    struct ilist recent;
+    ilist_init(&recent);
+    for (int i = 0; i < 10; i++) {
+        ilist_add_first(&recent, &items[i].recent);
+    }
+    ilist_unlink(&recent, &items[7].recent);
+    ilist_add_first(&recent, &items[7].recent);
+    assert(container_of(ilist_get_first(&recent), struct intrusiveTestItem, recent)->value == 7);
+    assert(ilist_contains(&list, &items[7].byValue));
+
+    ilist_clear(&list);
+    ilist_clear(&recent);
+    assert(list.size == 0 && list.head == NULL && list.tail == NULL);
+    assert(ilist_remove_first(&recent) == NULL);
+    printf("✓ Items in two lists working correctly\n\n");
+
+    printf("✓ All intrusive list tests passed!\n");
+}
\ No newline at end of file
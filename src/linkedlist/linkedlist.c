@@ -1,26 +1,63 @@
 #include "linkedlist.h"
+#include "linkedlist_internal.h"
+#include "../vector/vector.h"
+#include "../allocation/allocator.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 
 struct list* newList() {
-    struct list* list = malloc(sizeof(struct list));
+    return newListWithAllocator(&allocator_libc);
+}
+
+struct list* newListWithAllocator(const struct allocator* allocator) {
+    struct list* list = allocator_malloc(allocator, sizeof(struct list));
     list->size = 0;
     list->head = NULL;
     list->tail = NULL;
+    list->skipIndex = NULL;
+    list->pool = NULL;
+    list->allocator = allocator;
+    return list;
+}
+
+struct list* newPooledList() {
+    return newPooledListWithAllocator(&allocator_libc);
+}
+
+struct list* newPooledListWithAllocator(const struct allocator* allocator) {
+    struct list* list = newListWithAllocator(allocator);
+    list->pool = newListNodePool(allocator);
+    return list;
+}
+
+struct list* newListSharingPool(const struct list* other) {
+    struct list* list = newListWithAllocator(other->allocator);
+    list->pool = other->pool;
+    retainListNodePool(list->pool);
     return list;
 }
 
-static struct listEntry* newListEntry(int data) {
-    // NOLINTNEXTLINE
-    struct listEntry* entry = malloc(sizeof(struct listEntry));
+static struct listEntry* newListEntry(const struct list* list, int data) {
+    struct listEntry* entry = list->pool != NULL
+                                  ? listNodePoolAlloc(list->pool)
+                                  : allocator_malloc(list->allocator, sizeof(struct listEntry));
     entry->data = data;
     entry->next = NULL;
     entry->prev = NULL;
     return entry;
 }
 
+static void freeListEntry(const struct list* list, struct listEntry* entry) {
+    if (list->pool != NULL) {
+        listNodePoolFree(list->pool, entry);
+    } else {
+        allocator_free(list->allocator, entry, sizeof(struct listEntry));
+    }
+}
+
 static bool isValidIndex(const struct list* list, int index) {
     if (index < 0 || index >= list->size) {
         return false;
@@ -35,19 +72,28 @@ static struct listEntry* getNodeAt(const struct list* list, int index) {
         exit(EXIT_FAILURE);
     }
 
-    struct listEntry* entry = list->head;
-    int entryIndex = 0;
+    if (list->skipIndex != NULL) {
+        return skipIndexFind(list, index);
+    }
 
-    while (entryIndex != index && entry != NULL) {
-        entry = entry->next;
-        entryIndex++;
+    // Walk from whichever end is closer
+    if (index < list->size / 2) {
+        struct listEntry* entry = list->head;
+        for (int entryIndex = 0; entryIndex != index; entryIndex++) {
+            entry = entry->next;
+        }
+        return entry;
     }
 
+    struct listEntry* entry = list->tail;
+    for (int entryIndex = list->size - 1; entryIndex != index; entryIndex--) {
+        entry = entry->prev;
+    }
     return entry;
 }
 
 void addFirst(struct list* list, int data) {
-    struct listEntry* entry = newListEntry(data);
+    struct listEntry* entry = newListEntry(list, data);
     entry->next = list->head;
     if (list->head != NULL) {
         list->head->prev = entry;
@@ -56,6 +102,7 @@ void addFirst(struct list* list, int data) {
     if (list->tail == NULL) {
         list->tail = list->head;
     }
+    skipIndexInserted(list, 0, entry);
     list->size++;
 }
 
@@ -71,7 +118,7 @@ void addBefore(struct list* list, int index, int data) {
     }
 
     struct listEntry* nodeAt = getNodeAt(list, index);
-    struct listEntry* entry = newListEntry(data);
+    struct listEntry* entry = newListEntry(list, data);
 
     if (nodeAt->prev == NULL) { // if prev is null, means this head
         list->head = entry;
@@ -84,6 +131,7 @@ void addBefore(struct list* list, int index, int data) {
         nodeAt->prev = entry;
     }
 
+    skipIndexInserted(list, index, entry);
     list->size++;
 }
 
@@ -100,11 +148,12 @@ void addAfter(struct list* list, int index, int data) {
 
     // if you want to add after tail
     if (index == list->size - 1) {
-        struct listEntry* entry = newListEntry(data);
+        struct listEntry* entry = newListEntry(list, data);
 
         list->tail->next = entry;
         entry->prev = list->tail;
         list->tail = entry;
+        skipIndexInserted(list, list->size, entry);
         list->size++;
         return;
     }
@@ -113,7 +162,7 @@ void addAfter(struct list* list, int index, int data) {
 }
 
 void addLast(struct list* list, int data) {
-    struct listEntry* entry = newListEntry(data);
+    struct listEntry* entry = newListEntry(list, data);
     entry->prev = list->tail;
     if (list->tail != NULL) {
         list->tail->next = entry;
@@ -122,6 +171,7 @@ void addLast(struct list* list, int data) {
     if (list->head == NULL) {
         list->head = list->tail;
     }
+    skipIndexInserted(list, list->size, entry);
     list->size++;
 }
 
@@ -131,6 +181,7 @@ void removeFirst(struct list* list) {
     }
 
     struct listEntry* head = list->head;
+    skipIndexRemoving(list, 0, head);
     list->head = list->head->next;
 
     if (list->head != NULL) {
@@ -139,7 +190,7 @@ void removeFirst(struct list* list) {
         list->tail = NULL;
     }
 
-    free(head);
+    freeListEntry(list, head);
     list->size--;
 }
 
@@ -149,6 +200,7 @@ void removeAt(struct list* list, const int index) {
     }
 
     struct listEntry* node = getNodeAt(list, index);
+    skipIndexRemoving(list, index, node);
 
     if (node->prev == NULL && node->next == NULL) {
         list->head = NULL;
@@ -165,7 +217,7 @@ void removeAt(struct list* list, const int index) {
     }
 
     list->size--;
-    free(node);
+    freeListEntry(list, node);
 }
 
 void removeLast(struct list* list) {
@@ -174,6 +226,7 @@ void removeLast(struct list* list) {
     }
 
     struct listEntry* tail = list->tail;
+    skipIndexRemoving(list, list->size - 1, tail);
     list->tail = list->tail->prev;
 
     if (list->tail != NULL) {
@@ -182,7 +235,7 @@ void removeLast(struct list* list) {
         list->head = NULL;
     }
 
-    free(tail);
+    freeListEntry(list, tail);
     list->size--;
 }
 
@@ -206,9 +259,8 @@ int getLast(const struct list* list) {
 int findIndexOfValue(const struct list* list, int data) {
     int index = 0;
 
-    while (index < list->size) {
-        const int value = getAt(list, index);
-        if (value == data) {
+    for (const struct listEntry* entry = list->head; entry != NULL; entry = entry->next) {
+        if (entry->data == data) {
             return index;
         }
         index++;
@@ -239,29 +291,434 @@ void reverseList(struct list* list) {
     temp = list->head;
     list->head = list->tail;
     list->tail = temp;
+
+    skipIndexInvalidate(list);
+}
+
+void list_enable_skip_index(struct list* list) {
+    if (list->skipIndex == NULL) {
+        list->skipIndex = newSkipIndex(list->allocator); // built on the first lookup
+    }
+}
+
+void list_disable_skip_index(struct list* list) {
+    if (list->skipIndex != NULL) {
+        freeSkipIndex(list->skipIndex);
+        list->skipIndex = NULL;
+    }
+}
+
+// Takes entry out of the chain without freeing it, its index isn't known so any skip index goes stale
+static void unlinkEntry(struct list* list, struct listEntry* entry) {
+    if (entry->prev == NULL) { // if prev is null, it's the head
+        list->head = entry->next;
+    } else {
+        entry->prev->next = entry->next;
+    }
+
+    if (entry->next == NULL) { // if next is null, it's the tail
+        list->tail = entry->prev;
+    } else {
+        entry->next->prev = entry->prev;
+    }
+
+    list->size--;
+    skipIndexInvalidate(list);
+}
+
+void list_move_to_front(struct list* list, struct listEntry* entry) {
+    if (entry == list->head) {
+        return;
+    }
+
+    unlinkEntry(list, entry);
+    entry->prev = NULL;
+    entry->next = list->head;
+    if (list->head != NULL) {
+        list->head->prev = entry;
+    } else {
+        list->tail = entry;
+    }
+    list->head = entry;
+    list->size++;
+}
+
+void list_remove_node(struct list* list, struct listEntry* entry) {
+    unlinkEntry(list, entry);
+    freeListEntry(list, entry);
+}
+
+// Entries can only be relinked into a list that would free them the same way
+static bool canShareEntries(const struct list* first, const struct list* second) {
+    return first->pool == second->pool && (first->pool != NULL || first->allocator == second->allocator);
+}
+
+void list_splice(struct list* dst, int position, struct list* src) {
+    if (position < 0 || position > dst->size || src == dst || src->size == 0) {
+        return;
+    }
+
+    if (!canShareEntries(dst, src)) {
+        // Different allocators, so the entries are copied over one by one
+        struct listEntry* before = position < dst->size ? getNodeAt(dst, position) : NULL;
+        for (struct listEntry* entry = src->head; entry != NULL; entry = entry->next) {
+            struct listEntry* copy = newListEntry(dst, entry->data);
+            copy->next = before;
+            copy->prev = before != NULL ? before->prev : dst->tail;
+            if (copy->prev != NULL) {
+                copy->prev->next = copy;
+            } else {
+                dst->head = copy;
+            }
+            if (before != NULL) {
+                before->prev = copy;
+            } else {
+                dst->tail = copy;
+            }
+            dst->size++;
+        }
+
+        while (src->head != NULL) {
+            removeFirst(src);
+        }
+        skipIndexInvalidate(dst);
+        return;
+    }
+
+    struct listEntry* first = src->head;
+    struct listEntry* last = src->tail;
+    struct listEntry* before = position < dst->size ? getNodeAt(dst, position) : NULL;
+    struct listEntry* after = before != NULL ? before->prev : dst->tail;
+
+    first->prev = after;
+    last->next = before;
+    if (after != NULL) {
+        after->next = first;
+    } else {
+        dst->head = first;
+    }
+    if (before != NULL) {
+        before->prev = last;
+    } else {
+        dst->tail = last;
+    }
+
+    dst->size += src->size;
+    src->size = 0;
+    src->head = NULL;
+    src->tail = NULL;
+    skipIndexInvalidate(dst);
+    skipIndexInvalidate(src);
+}
+
+struct list* list_split_at(struct list* list, int index) {
+    struct list* rest = list->pool != NULL ? newListSharingPool(list) : newListWithAllocator(list->allocator);
+    if (index < 0 || index >= list->size) {
+        return rest;
+    }
+
+    struct listEntry* first = getNodeAt(list, index);
+    rest->head = first;
+    rest->tail = list->tail;
+    rest->size = list->size - index;
+
+    list->tail = first->prev;
+    if (list->tail != NULL) {
+        list->tail->next = NULL;
+    } else {
+        list->head = NULL;
+    }
+    first->prev = NULL;
+    list->size = index;
+
+    skipIndexInvalidate(list);
+    return rest;
+}
+
+// Merges two sorted NULL terminated runs by their next pointers, taking from left on ties so it stays stable
+static struct listEntry* mergeRuns(struct listEntry* left, struct listEntry* right, struct listEntry** last) {
+    struct listEntry head;
+    struct listEntry* tail = &head;
+
+    while (left != NULL && right != NULL) {
+        if (right->data < left->data) {
+            tail->next = right;
+            right = right->next;
+        } else {
+            tail->next = left;
+            left = left->next;
+        }
+        tail = tail->next;
+    }
+
+    tail->next = left != NULL ? left : right;
+    while (tail->next != NULL) {
+        tail = tail->next;
+    }
+
+    *last = tail;
+    return head.next;
+}
+
+// Cuts count entries off the front of run, returns what comes after them
+static struct listEntry* cutRun(struct listEntry* run, int count) {
+    for (int i = 1; run != NULL && i < count; i++) {
+        run = run->next;
+    }
+
+    if (run == NULL) {
+        return NULL;
+    }
+
+    struct listEntry* rest = run->next;
+    run->next = NULL;
+    return rest;
+}
+
+void list_sort(struct list* list) {
+    if (list->size < 2) {
+        return;
+    }
+
+    // Bottom up, merging runs of 1, 2, 4, ... along the next pointers, prev is fixed at the end
+    struct listEntry* sorted = list->head;
+    for (int width = 1; width < list->size; width *= 2) {
+        struct listEntry head;
+        struct listEntry* tail = &head;
+        struct listEntry* rest = sorted;
+
+        while (rest != NULL) {
+            struct listEntry* left = rest;
+            struct listEntry* right = cutRun(left, width);
+            rest = cutRun(right, width);
+
+            struct listEntry* last;
+            tail->next = mergeRuns(left, right, &last);
+            tail = last;
+        }
+
+        sorted = head.next;
+    }
+
+    struct listEntry* prev = NULL;
+    for (struct listEntry* entry = sorted; entry != NULL; entry = entry->next) {
+        entry->prev = prev;
+        prev = entry;
+    }
+    list->head = sorted;
+    list->tail = prev;
+
+    skipIndexInvalidate(list);
+}
+
+int list_to_array(const struct list* list, int* out) {
+    int index = 0;
+    for (const struct listEntry* entry = list->head; entry != NULL; entry = entry->next) {
+        out[index++] = entry->data;
+    }
+    return index;
+}
+
+struct vector* list_to_vector(const struct list* list) {
+    struct vector* vector = vector_new();
+    vector_reserve(vector, list->size);
+    vector->size = list_to_array(list, vector->head);
+    return vector;
+}
+
+#define WRITE_BUFFER_SIZE 65536
+#define MAX_ENTRY_TEXT 16 // " -> " and an int with its sign
+
+static const char digitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes value as decimal text at out, two digits per step, returns how many chars it took
+static int formatInt(int value, char* out) {
+    char digits[12];
+    int start = sizeof(digits);
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int) value : (unsigned int) value;
+
+    while (magnitude >= 100) {
+        const unsigned int pair = (magnitude % 100) * 2;
+        magnitude /= 100;
+        digits[--start] = digitPairs[pair + 1];
+        digits[--start] = digitPairs[pair];
+    }
+    if (magnitude >= 10) {
+        digits[--start] = digitPairs[magnitude * 2 + 1];
+        digits[--start] = digitPairs[magnitude * 2];
+    } else {
+        digits[--start] = (char) ('0' + magnitude);
+    }
+    if (value < 0) {
+        digits[--start] = '-';
+    }
+
+    const int length = (int) sizeof(digits) - start;
+    memcpy(out, digits + start, length);
+    return length;
+}
+
+bool list_write(const struct list* list, FILE* stream) {
+    char buffer[WRITE_BUFFER_SIZE];
+    int used = 0;
+
+    for (const struct listEntry* entry = list->head; entry != NULL; entry = entry->next) {
+        if (used > WRITE_BUFFER_SIZE - MAX_ENTRY_TEXT) {
+            fwrite(buffer, 1, used, stream);
+            used = 0;
+        }
+
+        if (entry != list->head) {
+            memcpy(buffer + used, " -> ", 4);
+            used += 4;
+        }
+        used += formatInt(entry->data, buffer + used);
+    }
+
+    buffer[used++] = '\n';
+    fwrite(buffer, 1, used, stream);
+    return !ferror(stream);
+}
+
+struct listIterator list_iter_begin(struct list* list) {
+    return (struct listIterator) {list, list->head, 0};
+}
+
+struct listIterator list_iter_end(struct list* list) {
+    return (struct listIterator) {list, list->tail, list->size - 1};
+}
+
+bool list_iter_valid(const struct listIterator* iterator) {
+    return iterator->node != NULL;
+}
+
+void list_iter_next(struct listIterator* iterator) {
+    if (iterator->node == NULL) {
+        return;
+    }
+
+    iterator->node = iterator->node->next;
+    iterator->index++;
+}
+
+void list_iter_prev(struct listIterator* iterator) {
+    if (iterator->node == NULL) {
+        return;
+    }
+
+    iterator->node = iterator->node->prev;
+    iterator->index--;
+}
+
+int list_iter_get(const struct listIterator* iterator) {
+    if (iterator->node == NULL) {
+        return -1;
+    }
+
+    return iterator->node->data;
+}
+
+void list_iter_set(const struct listIterator* iterator, int data) {
+    if (iterator->node == NULL) {
+        return;
+    }
+
+    iterator->node->data = data;
+}
+
+void list_iter_insert_before(struct listIterator* iterator, int data) {
+    struct list* list = iterator->list;
+    struct listEntry* nodeAt = iterator->node;
+
+    if (nodeAt == NULL) {
+        if (iterator->index < 0) {
+            addFirst(list, data); // before the head, and it stays there at -1
+        } else {
+            addLast(list, data);
+            iterator->index = list->size;
+        }
+        return;
+    }
+
+    struct listEntry* entry = newListEntry(list, data);
+    entry->next = nodeAt;
+    entry->prev = nodeAt->prev;
+
+    if (nodeAt->prev == NULL) { // if prev is null, means this head
+        list->head = entry;
+    } else {
+        nodeAt->prev->next = entry;
+    }
+    nodeAt->prev = entry;
+
+    skipIndexInserted(list, iterator->index, entry);
+    list->size++;
+    iterator->index++;
+}
+
+void list_iter_remove(struct listIterator* iterator) {
+    struct list* list = iterator->list;
+    struct listEntry* node = iterator->node;
+
+    if (node == NULL) {
+        return;
+    }
+
+    skipIndexRemoving(list, iterator->index, node);
+
+    if (node->prev == NULL) { // if prev is null, it's the head
+        list->head = node->next;
+    } else {
+        node->prev->next = node->next;
+    }
+
+    if (node->next == NULL) { // if next is null, it's the tail
+        list->tail = node->prev;
+    } else {
+        node->next->prev = node->prev;
+    }
+
+    iterator->node = node->next;
+    list->size--;
+    freeListEntry(list, node);
 }
 
 void freeList(struct list* list) {
-    struct listEntry* entry = list->head;
+    // A pool nobody else uses goes away page by page, no need to visit the entries
+    if (list->pool != NULL && list->pool->refCount == 1) {
+        releaseListNodePool(list->pool);
+    } else {
+        struct listEntry* entry = list->head;
 
-    while (entry != NULL) {
-        struct listEntry* temp = entry;
-        entry = entry->next;
-        free(temp);
+        while (entry != NULL) {
+            struct listEntry* temp = entry;
+            entry = entry->next;
+            freeListEntry(list, temp);
+        }
+
+        if (list->pool != NULL) {
+            releaseListNodePool(list->pool);
+        }
     }
 
-    free(list);
+    if (list->skipIndex != NULL) {
+        freeSkipIndex(list->skipIndex);
+    }
+    allocator_free(list->allocator, list, sizeof(struct list));
 }
 
 void printList(const struct list* list) {
     printf("Printing list of size %i:\n", list->size);
-    const struct listEntry* entry = list->head;
-    while (entry != NULL) {
-        printf("%i", entry->data);
-        entry = entry->next;
-        if (entry != NULL) {
-            printf(" -> ");
-        }
-    }
-    printf("\nDone printing\n");
+    list_write(list, stdout);
+    printf("Done printing\n");
 }
\ No newline at end of file
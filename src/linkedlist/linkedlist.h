@@ -1,6 +1,10 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdio.h>
+
+struct vector;
+struct allocator;
 
 struct listEntry {
     int data;
@@ -12,9 +16,26 @@ struct list {
     int size;
     struct listEntry* head;
     struct listEntry* tail;
+    struct listSkipIndex* skipIndex; // NULL unless list_enable_skip_index was called
+    struct listNodePool* pool; // NULL when entries come straight from allocator
+    const struct allocator* allocator; // the list itself, its entries or pool, and the skip index
+};
+
+// Cursor over a list, node is NULL once it has moved past either end
+struct listIterator {
+    struct list* list;
+    struct listEntry* node;
+    int index;
 };
 
 struct list* newList();
+// Entries come from a pool of slab pages owned by the list, freeList drops whole pages
+struct list* newPooledList();
+// Same as above with everything the list allocates coming from allocator, which has to outlive the list
+struct list* newListWithAllocator(const struct allocator* allocator);
+struct list* newPooledListWithAllocator(const struct allocator* allocator);
+// Uses the same pool as other (which must be pooled), so entries can move between the two
+struct list* newListSharingPool(const struct list* other);
 
 void addFirst(struct list* list, int data);
 void addBefore(struct list* list, int index, int data);
@@ -33,5 +54,44 @@ int findIndexOfValue(const struct list* list, int data);
 bool containsValue(const struct list* list, int data);
 void reverseList(struct list* list);
 
+// Keeps a skip list over the entries so getAt, addBefore and removeAt by index are O(log n)
+// instead of a walk, at the cost of some extra memory and work on every add and remove
+void list_enable_skip_index(struct list* list);
+void list_disable_skip_index(struct list* list);
+
+// O(1) given the entry itself, for callers that keep hold of entries (eg. head right after addFirst)
+void list_move_to_front(struct list* list, struct listEntry* entry);
+void list_remove_node(struct list* list, struct listEntry* entry);
+
+// Moves every entry of src into dst before position (dst->size appends), leaving src empty.
+// O(1) apart from finding position when both lists allocate entries the same way, otherwise they're copied
+void list_splice(struct list* dst, int position, struct list* src);
+// Moves the entries from index on into a new list (sharing the pool, if any) and returns it
+struct list* list_split_at(struct list* list, int index);
+// Stable ascending merge sort, relinks the entries in place without allocating
+void list_sort(struct list* list);
+
+// Copies the values in order into out, which must have room for list->size of them, returns how many
+int list_to_array(const struct list* list, int* out);
+// New vector holding the values in order, sized up front so it never regrows
+struct vector* list_to_vector(const struct list* list);
+// Writes the values as "1 -> 2 -> 3\n" through one big buffer instead of a printf per value,
+// returns false if the stream reported an error
+bool list_write(const struct list* list, FILE* stream);
+
+// for (struct listIterator it = list_iter_begin(list); list_iter_valid(&it); list_iter_next(&it))
+struct listIterator list_iter_begin(struct list* list);
+struct listIterator list_iter_end(struct list* list); // at the tail, for walking backwards with list_iter_prev
+bool list_iter_valid(const struct listIterator* iterator);
+void list_iter_next(struct listIterator* iterator);
+void list_iter_prev(struct listIterator* iterator);
+int list_iter_get(const struct listIterator* iterator);
+void list_iter_set(const struct listIterator* iterator, int data);
+// Inserts before the cursor, the cursor stays on the same element. Past the end that appends,
+// before the head (list_iter_prev off the first element) it prepends and the cursor stays before the head
+void list_iter_insert_before(struct listIterator* iterator, int data);
+// Removes the element under the cursor and moves the cursor to the one after it
+void list_iter_remove(struct listIterator* iterator);
+
 void freeList(struct list* list);
 void printList(const struct list* list);
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include "linkedlist.h"
+
+// Indexable skip list over the entries of a list, level 0 is the list itself and every
+// level above it holds roughly a quarter of the entries of the one below. Each link
+// stores how many entries it jumps over, so finding an index is O(log n).
+//
+// Operations that know the index of what they change keep the index up to date, the
+// rest (eg. reversing) just mark it dirty and it gets rebuilt on the next lookup.
+
+#define SKIP_INDEX_MAX_LEVEL 16
+
+struct skipNode {
+    struct listEntry* entry; // NULL for the head of a level, which sits before index 0
+    struct skipNode* next;
+    struct skipNode* down; // same entry one level lower, NULL on level 1
+    int width; // index of next minus index of this, unused when next is NULL
+};
+
+struct listSkipIndex {
+    const struct allocator* allocator; // the list's, for the index and all its nodes
+    bool isDirty;
+    unsigned int randomState;
+    struct skipNode heads[SKIP_INDEX_MAX_LEVEL + 1]; // heads[0] unused, level 0 is the list
+};
+
+struct listSkipIndex* newSkipIndex(const struct allocator* allocator);
+void freeSkipIndex(struct listSkipIndex* index);
+
+struct listEntry* skipIndexFind(const struct list* list, int index);
+void skipIndexInserted(struct list* list, int index, struct listEntry* entry); // entry is now at index
+void skipIndexRemoving(struct list* list, int index, const struct listEntry* entry); // entry at index is about to go
+void skipIndexInvalidate(struct list* list);
+
+// Slab allocator for list entries. Entries are handed out from fixed size pages and
+// recycled through a free list threaded through their next pointers, so add/remove churn
+// never reaches malloc and neighbouring entries tend to share cache lines. Pages are only
+// given back when the last list using the pool is freed. Not thread safe, like the lists.
+
+#define LIST_POOL_PAGE_BYTES 4096
+
+struct listPoolPage {
+    struct listPoolPage* nextPage;
+    struct listEntry entries[];
+};
+
+#define LIST_POOL_PAGE_ENTRIES \
+    ((int) ((LIST_POOL_PAGE_BYTES - sizeof(struct listPoolPage)) / sizeof(struct listEntry)))
+
+struct listNodePool {
+    int refCount; // lists using the pool
+    const struct allocator* allocator; // where the pool itself and its pages come from
+    struct listPoolPage* pages;
+    int usedInFirstPage; // entries of pages (the newest page) handed out so far
+    struct listEntry* freeEntries;
+};
+
+struct listNodePool* newListNodePool(const struct allocator* allocator);
+void retainListNodePool(struct listNodePool* pool);
+void releaseListNodePool(struct listNodePool* pool);
+
+struct listEntry* listNodePoolAlloc(struct listNodePool* pool);
+void listNodePoolFree(struct listNodePool* pool, struct listEntry* entry);
\ No newline at end of file
@@ -1,8 +1,12 @@
 // ReSharper disable CppLocalVariableMayBeConst
 #pragma once
 #include "linkedlist.h"
+#include "linkedlist_internal.h"
+#include "../vector/vector.h"
 #include <stdio.h>
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 void testLinkedListImpl() {
     printf("=== Linked List Comprehensive Test ===\n\n");
@@ -208,4 +212,445 @@ void testLinkedListImpl() {
 
     freeList(finalTest);
     printf("✓ All tests passed! Your linked list implementation is working correctly.\n");
-}
\ No newline at end of file
+}
+
+void testLinkedListIterator() {
+    printf("=== Linked List Iterator Test ===\n\n");
+
+    // Test 1: Walking forwards and backwards
+    printf("Test 1: Iterating in both directions\n");
+    struct list* myList = newList();
+    for (int i = 0; i < 10; i++) {
+        addLast(myList, i);
+    }
+
+    int expected = 0;
+    for (struct listIterator it = list_iter_begin(myList); list_iter_valid(&it); list_iter_next(&it)) {
+        assert(it.index == expected);
+        assert(list_iter_get(&it) == expected);
+        expected++;
+    }
+    assert(expected == 10);
+
+    for (struct listIterator it = list_iter_end(myList); list_iter_valid(&it); list_iter_prev(&it)) {
+        expected--;
+        assert(it.index == expected);
+        assert(list_iter_get(&it) == expected);
+    }
+    assert(expected == 0);
+    printf("✓ Iteration working correctly\n\n");
+
+    // Test 2: Editing through the cursor
+    printf("Test 2: Inserting, removing and setting at the cursor\n");
+    for (struct listIterator it = list_iter_begin(myList); list_iter_valid(&it);) {
+        const int value = list_iter_get(&it);
+        if (value % 2 == 0) {
+            list_iter_remove(&it); // Moves on by itself
+        } else {
+            list_iter_insert_before(&it, value * 100);
+            list_iter_set(&it, -value);
+            list_iter_next(&it);
+        }
+    }
+    // 100 -> -1 -> 300 -> -3 -> ... -> 900 -> -9
+    assert(myList->size == 10);
+    assert(getFirst(myList) == 100);
+    assert(getAt(myList, 1) == -1);
+    assert(getLast(myList) == -9);
+    assert(myList->tail->prev->data == 900);
+
+    // Removing down to nothing keeps head and tail right
+    struct listIterator it = list_iter_begin(myList);
+    while (list_iter_valid(&it)) {
+        list_iter_remove(&it);
+    }
+    assert(myList->size == 0);
+    assert(myList->head == NULL);
+    assert(myList->tail == NULL);
+
+    // Inserting at the end cursor appends
+    list_iter_insert_before(&it, 7);
+    it = list_iter_begin(myList);
+    list_iter_insert_before(&it, 6);
+    assert(getFirst(myList) == 6);
+    assert(getLast(myList) == 7);
+
+    // Inserting before a cursor that stepped off the front prepends
+    it = list_iter_begin(myList);
+    list_iter_prev(&it);
+    assert(!list_iter_valid(&it) && it.index == -1);
+    list_iter_insert_before(&it, 5);
+    assert(it.index == -1);
+    assert(myList->size == 3);
+    assert(getFirst(myList) == 5);
+    assert(getLast(myList) == 7);
+    printf("✓ Cursor editing working correctly\n\n");
+
+    // Test 3: Search is a single pass now
+    printf("Test 3: Searching a large list\n");
+    struct list* largeList = newList();
+    for (int i = 0; i < 100000; i++) {
+        addLast(largeList, i);
+    }
+    assert(findIndexOfValue(largeList, 99999) == 99999);
+    assert(containsValue(largeList, 100000) == false);
+    printf("✓ Searching working correctly\n\n");
+
+    freeList(myList);
+    freeList(largeList);
+    printf("✓ All iterator tests passed!\n");
+}
+
+void testLinkedListSkipIndex() {
+    printf("=== Linked List Skip Index Test ===\n\n");
+
+    // Test 1: Walking from the tail end without an index
+    printf("Test 1: Indexing near both ends\n");
+    struct list* myList = newList();
+    for (int i = 0; i < 1000; i++) {
+        addLast(myList, i);
+    }
+    assert(getAt(myList, 0) == 0);
+    assert(getAt(myList, 499) == 499);
+    assert(getAt(myList, 500) == 500);
+    assert(getAt(myList, 998) == 998);
+    addBefore(myList, 990, -1);
+    assert(getAt(myList, 990) == -1);
+    assert(getAt(myList, 991) == 990);
+    removeAt(myList, 990);
+    assert(getAt(myList, 990) == 990);
+    printf("✓ Indexing from both ends working correctly\n\n");
+
+    // Test 2: Positional edits with the index on, checked against a plain array
+    printf("Test 2: Random edits with the skip index\n");
+    list_enable_skip_index(myList);
+    int expected[3000];
+    int expectedSize = 1000;
+    for (int i = 0; i < expectedSize; i++) {
+        expected[i] = i;
+    }
+
+    srand(39);
+    for (int step = 0; step < 4000; step++) {
+        const int operation = rand() % 6;
+        const int index = expectedSize > 0 ? rand() % expectedSize : 0;
+
+        if (operation <= 1 && expectedSize > 0 && expectedSize < 3000) {
+            addBefore(myList, index, step);
+            for (int i = expectedSize; i > index; i--) {
+                expected[i] = expected[i - 1];
+            }
+            expected[index] = step;
+            expectedSize++;
+        } else if (operation == 2 && expectedSize > 0) {
+            removeAt(myList, index);
+            for (int i = index; i < expectedSize - 1; i++) {
+                expected[i] = expected[i + 1];
+            }
+            expectedSize--;
+        } else if (operation == 3 && expectedSize < 3000) {
+            addFirst(myList, step);
+            for (int i = expectedSize; i > 0; i--) {
+                expected[i] = expected[i - 1];
+            }
+            expected[0] = step;
+            expectedSize++;
+        } else if (operation == 4 && expectedSize > 0) {
+            removeLast(myList);
+            expectedSize--;
+        } else if (expectedSize > 0) {
+            assert(getAt(myList, index) == expected[index]);
+        }
+
+        if (step % 1000 == 999) {
+            // Reversing throws the index away, it gets rebuilt on the next lookup
+            reverseList(myList);
+            for (int l = 0, r = expectedSize - 1; l < r; l++, r--) {
+                const int temp = expected[l];
+                expected[l] = expected[r];
+                expected[r] = temp;
+            }
+        }
+    }
+
+    assert(myList->size == expectedSize);
+    for (int i = 0; i < expectedSize; i++) {
+        assert(getAt(myList, i) == expected[i]);
+    }
+    printf("✓ Skip index stays in sync with the list\n\n");
+
+    // Test 3: Iterator edits keep the index up to date too
+    printf("Test 3: Iterator edits with the skip index\n");
+    int visited = 0;
+    for (struct listIterator it = list_iter_begin(myList); list_iter_valid(&it); visited++) {
+        if (visited % 3 == 0) {
+            list_iter_remove(&it);
+        } else {
+            list_iter_insert_before(&it, -list_iter_get(&it));
+            list_iter_next(&it);
+        }
+    }
+    int index = 0;
+    for (const struct listEntry* entry = myList->head; entry != NULL; entry = entry->next) {
+        assert(getAt(myList, index) == entry->data);
+        index++;
+    }
+    assert(index == myList->size);
+    assert(myList->size > 0);
+
+    list_disable_skip_index(myList);
+    assert(myList->skipIndex == NULL);
+    assert(getAt(myList, myList->size - 1) == getLast(myList));
+    printf("✓ Iterator edits working correctly\n\n");
+
+    freeList(myList);
+    printf("✓ All skip index tests passed!\n");
+}
+
+
+void testLinkedListPool() {
+    printf("=== Linked List Pool Test ===\n\n");
+
+    // Test 1: Pooled lists behave like plain ones
+    printf("Test 1: Adding and removing with a pool\n");
+    struct list* myList = newPooledList();
+    assert(myList->pool != NULL);
+    for (int i = 0; i < 1000; i++) {
+        addLast(myList, i);
+    }
+    addFirst(myList, -1);
+    addBefore(myList, 500, -2);
+    addAfter(myList, 1001, -3);
+    assert(myList->size == 1003);
+    assert(getFirst(myList) == -1);
+    assert(getAt(myList, 500) == -2);
+    assert(getLast(myList) == -3);
+
+    removeFirst(myList);
+    removeAt(myList, 499);
+    removeLast(myList);
+    assert(myList->size == 1000);
+    for (int i = 0; i < 1000; i++) {
+        assert(getAt(myList, i) == i);
+    }
+    printf("✓ Pooled list working correctly\n\n");
+
+    // Test 2: Removed entries get reused instead of taking new memory
+    printf("Test 2: Recycling entries\n");
+    struct listEntry* tail = myList->tail;
+    removeLast(myList);
+    addLast(myList, 42);
+    assert(myList->tail == tail);
+    assert(getLast(myList) == 42);
+
+    for (int round = 0; round < 100; round++) {
+        for (int i = 0; i < 1000; i++) {
+            removeFirst(myList);
+        }
+        for (int i = 0; i < 1000; i++) {
+            addLast(myList, i);
+        }
+    }
+
+    int pages = 0;
+    for (const struct listPoolPage* page = myList->pool->pages; page != NULL; page = page->nextPage) {
+        pages++;
+    }
+    assert(pages == (1003 + LIST_POOL_PAGE_ENTRIES - 1) / LIST_POOL_PAGE_ENTRIES);
+    printf("✓ Entries recycled correctly\n\n");
+
+    // Test 3: Lists sharing a pool free independently
+    printf("Test 3: Sharing a pool\n");
+    struct list* otherList = newListSharingPool(myList);
+    assert(otherList->pool == myList->pool);
+    assert(myList->pool->refCount == 2);
+    for (int i = 0; i < 10; i++) {
+        addLast(otherList, i);
+    }
+
+    freeList(myList);
+    assert(otherList->pool->refCount == 1);
+    for (int i = 0; i < 10; i++) {
+        assert(getAt(otherList, i) == i);
+    }
+    freeList(otherList);
+    printf("✓ Shared pool working correctly\n\n");
+
+    printf("✓ All pool tests passed!\n");
+}
+
+
+static void assertListMatches(const struct list* list, const int* expected, int size) {
+    assert(list->size == size);
+    int index = 0;
+    const struct listEntry* prev = NULL;
+    for (const struct listEntry* entry = list->head; entry != NULL; entry = entry->next) {
+        assert(entry->prev == prev);
+        assert(entry->data == expected[index]);
+        prev = entry;
+        index++;
+    }
+    assert(index == size);
+    assert(list->tail == prev);
+}
+
+void testLinkedListSpliceSortSplit() {
+    printf("=== Linked List Splice, Split and Sort Test ===\n\n");
+
+    // Test 1: Splicing at the front, middle and end
+    printf("Test 1: Splicing lists\n");
+    struct list* myList = newList();
+    struct list* other = newList();
+    addLast(myList, 1);
+    addLast(myList, 4);
+    addLast(other, 2);
+    addLast(other, 3);
+
+    list_splice(myList, 1, other);
+    assertListMatches(myList, (int[]) {1, 2, 3, 4}, 4);
+    assert(other->size == 0 && other->head == NULL && other->tail == NULL);
+
+    addLast(other, 0);
+    list_splice(myList, 0, other);
+    addLast(other, 5);
+    list_splice(myList, myList->size, other);
+    assertListMatches(myList, (int[]) {0, 1, 2, 3, 4, 5}, 6);
+
+    // Into an empty list, and from a list with a different pool
+    list_splice(other, 0, myList);
+    assertListMatches(other, (int[]) {0, 1, 2, 3, 4, 5}, 6);
+    struct list* pooled = newPooledList();
+    addLast(pooled, 9);
+    list_splice(pooled, 0, other);
+    assertListMatches(pooled, (int[]) {0, 1, 2, 3, 4, 5, 9}, 7);
+    assert(other->size == 0);
+    printf("✓ Splicing working correctly\n\n");
+
+    // Test 2: Splitting
+    printf("Test 2: Splitting lists\n");
+    struct list* back = list_split_at(pooled, 4);
+    assert(back->pool == pooled->pool);
+    assertListMatches(pooled, (int[]) {0, 1, 2, 3}, 4);
+    assertListMatches(back, (int[]) {4, 5, 9}, 3);
+
+    struct list* all = list_split_at(pooled, 0);
+    assertListMatches(pooled, NULL, 0);
+    assertListMatches(all, (int[]) {0, 1, 2, 3}, 4);
+
+    // Shared pool, so this is a relink
+    list_splice(all, 2, back);
+    assertListMatches(all, (int[]) {0, 1, 4, 5, 9, 2, 3}, 7);
+    printf("✓ Splitting working correctly\n\n");
+
+    // Test 3: Sorting, checking it's stable by where equal values' entries end up
+    printf("Test 3: Sorting lists\n");
+    struct list* toSort = newList();
+    list_enable_skip_index(toSort);
+    srand(43);
+    for (int i = 0; i < 5000; i++) {
+        addLast(toSort, rand() % 100);
+    }
+    assert(getAt(toSort, 2500) >= 0); // builds the skip index before sorting
+
+    struct listEntry* firstZero = NULL;
+    for (struct listEntry* entry = toSort->head; entry != NULL; entry = entry->next) {
+        if (entry->data == 0) {
+            firstZero = entry;
+            break;
+        }
+    }
+
+    list_sort(toSort);
+    assert(toSort->size == 5000);
+    const struct listEntry* prev = NULL;
+    for (const struct listEntry* entry = toSort->head; entry != NULL; entry = entry->next) {
+        assert(entry->prev == prev);
+        assert(prev == NULL || prev->data <= entry->data);
+        prev = entry;
+    }
+    assert(toSort->tail == prev);
+    assert(firstZero == NULL || toSort->head == firstZero);
+    assert(getAt(toSort, 0) == getFirst(toSort));
+    assert(getAt(toSort, 4999) == getLast(toSort));
+
+    list_sort(all);
+    assertListMatches(all, (int[]) {0, 1, 2, 3, 4, 5, 9}, 7);
+    printf("✓ Sorting working correctly\n\n");
+
+    freeList(myList);
+    freeList(other);
+    freeList(pooled);
+    freeList(back);
+    freeList(all);
+    freeList(toSort);
+    printf("✓ All splice, split and sort tests passed!\n");
+}
+
+
+void testLinkedListExport() {
+    printf("=== Linked List Export Test ===\n\n");
+
+    struct list* myList = newList();
+    for (int i = 0; i < 100000; i++) {
+        addLast(myList, i - 50000);
+    }
+
+    // Test 1: Into an array and a vector
+    printf("Test 1: Exporting to an array and a vector\n");
+    int* array = malloc(sizeof(int) * myList->size);
+    assert(list_to_array(myList, array) == 100000);
+    assert(array[0] == -50000 && array[99999] == 49999);
+
+    struct vector* vec = list_to_vector(myList);
+    assert(vec->size == 100000);
+    assert(memcmp(vec->head, array, sizeof(int) * 100000) == 0);
+    vector_free(vec);
+    free(array);
+
+    struct list* empty = newList();
+    vec = list_to_vector(empty);
+    assert(vec->size == 0);
+    vector_free(vec);
+    printf("✓ Exporting working correctly\n\n");
+
+    // Test 2: Writing, past the end of the buffer and with the extreme ints
+    printf("Test 2: Writing lists\n");
+    FILE* file = tmpfile();
+    assert(list_write(myList, file));
+    const long length = ftell(file);
+    rewind(file);
+    char* text = malloc(length + 1);
+    assert(fread(text, 1, length, file) == (size_t) length);
+    text[length] = '\0';
+
+    // Same text the slow way
+    char* expectedText = malloc(length + 1);
+    int written = 0;
+    for (int i = -50000; i < 50000; i++) {
+        written += sprintf(expectedText + written, i == -50000 ? "%i" : " -> %i", i);
+    }
+    written += sprintf(expectedText + written, "\n");
+    assert(written == length);
+    assert(strcmp(text, expectedText) == 0);
+    free(expectedText);
+    free(text);
+    fclose(file);
+
+    addLast(empty, -2147483647 - 1);
+    addLast(empty, 2147483647);
+    addLast(empty, 0);
+    addLast(empty, 7);
+    addLast(empty, -10);
+    file = tmpfile();
+    assert(list_write(empty, file));
+    rewind(file);
+    char line[128];
+    assert(fgets(line, sizeof(line), file) != NULL);
+    assert(strcmp(line, "-2147483648 -> 2147483647 -> 0 -> 7 -> -10\n") == 0);
+    fclose(file);
+    printf("✓ Writing working correctly\n\n");
+
+    freeList(myList);
+    freeList(empty);
+    printf("✓ All export tests passed!\n");
+}
@@ -0,0 +1,56 @@
+#include "linkedlist_internal.h"
+#include "../allocation/allocator.h"
+
+#include <stdlib.h>
+
+struct listNodePool* newListNodePool(const struct allocator* allocator) {
+    struct listNodePool* pool = allocator_malloc(allocator, sizeof(struct listNodePool));
+    pool->refCount = 1;
+    pool->allocator = allocator;
+    pool->pages = NULL;
+    pool->usedInFirstPage = LIST_POOL_PAGE_ENTRIES; // forces a page on the first alloc
+    pool->freeEntries = NULL;
+    return pool;
+}
+
+void retainListNodePool(struct listNodePool* pool) {
+    pool->refCount++;
+}
+
+void releaseListNodePool(struct listNodePool* pool) {
+    if (--pool->refCount > 0) {
+        return;
+    }
+
+    struct listPoolPage* page = pool->pages;
+    while (page != NULL) {
+        struct listPoolPage* temp = page;
+        page = page->nextPage;
+        allocator_free(pool->allocator, temp, LIST_POOL_PAGE_BYTES);
+    }
+
+    allocator_free(pool->allocator, pool, sizeof(struct listNodePool));
+}
+
+struct listEntry* listNodePoolAlloc(struct listNodePool* pool) {
+    // Recently freed entries first, they're the most likely to still be in cache
+    struct listEntry* entry = pool->freeEntries;
+    if (entry != NULL) {
+        pool->freeEntries = entry->next;
+        return entry;
+    }
+
+    if (pool->usedInFirstPage == LIST_POOL_PAGE_ENTRIES) {
+        struct listPoolPage* page = allocator_malloc(pool->allocator, LIST_POOL_PAGE_BYTES);
+        page->nextPage = pool->pages;
+        pool->pages = page;
+        pool->usedInFirstPage = 0;
+    }
+
+    return &pool->pages->entries[pool->usedInFirstPage++];
+}
+
+void listNodePoolFree(struct listNodePool* pool, struct listEntry* entry) {
+    entry->next = pool->freeEntries;
+    pool->freeEntries = entry;
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "linkedlist_internal.h"
+#include "../allocation/allocator.h"
+
+static struct skipNode* newSkipNode(const struct listSkipIndex* index, struct listEntry* entry) {
+    struct skipNode* node = allocator_malloc(index->allocator, sizeof(struct skipNode));
+    node->entry = entry;
+    node->next = NULL;
+    node->down = NULL;
+    node->width = 0;
+    return node;
+}
+
+static void resetHeads(struct listSkipIndex* index) {
+    for (int level = 1; level <= SKIP_INDEX_MAX_LEVEL; level++) {
+        struct skipNode* head = &index->heads[level];
+        head->entry = NULL;
+        head->next = NULL;
+        head->down = level > 1 ? &index->heads[level - 1] : NULL;
+        head->width = 0;
+    }
+}
+
+static void freeSkipNodes(struct listSkipIndex* index) {
+    for (int level = 1; level <= SKIP_INDEX_MAX_LEVEL; level++) {
+        struct skipNode* node = index->heads[level].next;
+        while (node != NULL) {
+            struct skipNode* temp = node;
+            node = node->next;
+            allocator_free(index->allocator, temp, sizeof(struct skipNode));
+        }
+    }
+    resetHeads(index);
+}
+
+struct listSkipIndex* newSkipIndex(const struct allocator* allocator) {
+    struct listSkipIndex* index = allocator_malloc(allocator, sizeof(struct listSkipIndex));
+    index->allocator = allocator;
+    index->isDirty = true;
+    index->randomState = 0x9E3779B9u;
+    resetHeads(index);
+    return index;
+}
+
+void freeSkipIndex(struct listSkipIndex* index) {
+    freeSkipNodes(index);
+    allocator_free(index->allocator, index, sizeof(struct listSkipIndex));
+}
+
+// How many levels above the list an entry goes up, each one with a 1 in 4 chance
+static int randomHeight(struct listSkipIndex* index) {
+    unsigned int x = index->randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    index->randomState = x;
+
+    int height = 0;
+    while (height < SKIP_INDEX_MAX_LEVEL && (x & 3) == 0) {
+        height++;
+        x >>= 2;
+    }
+    return height;
+}
+
+static void rebuild(const struct list* list, struct listSkipIndex* index) {
+    freeSkipNodes(index);
+
+    struct skipNode* lastAtLevel[SKIP_INDEX_MAX_LEVEL + 1];
+    int lastIndexAtLevel[SKIP_INDEX_MAX_LEVEL + 1];
+    for (int level = 1; level <= SKIP_INDEX_MAX_LEVEL; level++) {
+        lastAtLevel[level] = &index->heads[level];
+        lastIndexAtLevel[level] = -1;
+    }
+
+    int entryIndex = 0;
+    for (struct listEntry* entry = list->head; entry != NULL; entry = entry->next) {
+        const int height = randomHeight(index);
+        struct skipNode* below = NULL;
+
+        for (int level = 1; level <= height; level++) {
+            struct skipNode* node = newSkipNode(index, entry);
+            node->down = below;
+            lastAtLevel[level]->next = node;
+            lastAtLevel[level]->width = entryIndex - lastIndexAtLevel[level];
+            lastAtLevel[level] = node;
+            lastIndexAtLevel[level] = entryIndex;
+            below = node;
+        }
+
+        entryIndex++;
+    }
+
+    index->isDirty = false;
+}
+
+// Fills in the last node on every level that comes before target (index < target), and its index
+static void findPredecessors(struct listSkipIndex* index, int target,
+                             struct skipNode* predecessors[], int predecessorIndices[]) {
+    struct skipNode* node = &index->heads[SKIP_INDEX_MAX_LEVEL];
+    int position = -1;
+
+    for (int level = SKIP_INDEX_MAX_LEVEL; level >= 1; level--) {
+        while (node->next != NULL && position + node->width < target) {
+            position += node->width;
+            node = node->next;
+        }
+
+        predecessors[level] = node;
+        predecessorIndices[level] = position;
+
+        if (level > 1) {
+            node = node->down;
+        }
+    }
+}
+
+struct listEntry* skipIndexFind(const struct list* list, int index) {
+    struct listSkipIndex* skipIndex = list->skipIndex;
+    if (skipIndex->isDirty) {
+        rebuild(list, skipIndex);
+    }
+
+    // Last node on level 1 at or before index, then the rest of the way along the list
+    struct skipNode* predecessors[SKIP_INDEX_MAX_LEVEL + 1];
+    int predecessorIndices[SKIP_INDEX_MAX_LEVEL + 1];
+    findPredecessors(skipIndex, index + 1, predecessors, predecessorIndices);
+
+    struct listEntry* entry = predecessors[1]->entry;
+    int position = predecessorIndices[1];
+    if (entry == NULL) {
+        entry = list->head;
+        position = 0;
+    }
+
+    while (position < index) {
+        entry = entry->next;
+        position++;
+    }
+
+    return entry;
+}
+
+void skipIndexInserted(struct list* list, int index, struct listEntry* entry) {
+    struct listSkipIndex* skipIndex = list->skipIndex;
+    if (skipIndex == NULL || skipIndex->isDirty) {
+        return;
+    }
+
+    struct skipNode* predecessors[SKIP_INDEX_MAX_LEVEL + 1];
+    int predecessorIndices[SKIP_INDEX_MAX_LEVEL + 1];
+    findPredecessors(skipIndex, index, predecessors, predecessorIndices);
+
+    const int height = randomHeight(skipIndex);
+    struct skipNode* below = NULL;
+
+    for (int level = 1; level <= SKIP_INDEX_MAX_LEVEL; level++) {
+        struct skipNode* predecessor = predecessors[level];
+
+        if (level > height) {
+            // The link over the new entry now jumps one further
+            if (predecessor->next != NULL) {
+                predecessor->width++;
+            }
+            continue;
+        }
+
+        struct skipNode* node = newSkipNode(skipIndex, entry);
+        node->down = below;
+        node->next = predecessor->next;
+        if (node->next != NULL) {
+            // Where the old next was, plus one for the new entry, relative to the new entry
+            node->width = predecessorIndices[level] + predecessor->width + 1 - index;
+        }
+        predecessor->next = node;
+        predecessor->width = index - predecessorIndices[level];
+        below = node;
+    }
+}
+
+void skipIndexRemoving(struct list* list, int index, const struct listEntry* entry) {
+    struct listSkipIndex* skipIndex = list->skipIndex;
+    if (skipIndex == NULL || skipIndex->isDirty) {
+        return;
+    }
+
+    struct skipNode* predecessors[SKIP_INDEX_MAX_LEVEL + 1];
+    int predecessorIndices[SKIP_INDEX_MAX_LEVEL + 1];
+    findPredecessors(skipIndex, index, predecessors, predecessorIndices);
+
+    for (int level = 1; level <= SKIP_INDEX_MAX_LEVEL; level++) {
+        struct skipNode* predecessor = predecessors[level];
+        struct skipNode* next = predecessor->next;
+
+        if (next == NULL) {
+            continue;
+        }
+
+        if (next->entry == entry) {
+            predecessor->width = next->next != NULL ? predecessor->width + next->width - 1 : 0;
+            predecessor->next = next->next;
+            allocator_free(skipIndex->allocator, next, sizeof(struct skipNode));
+        } else {
+            predecessor->width--;
+        }
+    }
+}
+
+void skipIndexInvalidate(struct list* list) {
+    if (list->skipIndex != NULL) {
+        list->skipIndex->isDirty = true;
+    }
+}
\ No newline at end of file
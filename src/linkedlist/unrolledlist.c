@@ -0,0 +1,320 @@
+#include "unrolledlist.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nodes that drop below this after a removal get merged with their neighbour when they fit
+#define MERGE_THRESHOLD (UNROLLED_NODE_CAPACITY / 4)
+
+_Static_assert(sizeof(struct unrolledNode) <= UNROLLED_NODE_BYTES, "unrolledNode outgrew its cache lines");
+
+struct unrolledList* newUnrolledList() {
+    struct unrolledList* list = malloc(sizeof(struct unrolledList));
+    list->size = 0;
+    list->nodeCount = 0;
+    list->head = NULL;
+    list->tail = NULL;
+    return list;
+}
+
+static struct unrolledNode* newUnrolledNode() {
+    struct unrolledNode* node = aligned_alloc(64, UNROLLED_NODE_BYTES);
+    if (node == NULL) {
+        printf("failed to malloc");
+        exit(EXIT_FAILURE);
+    }
+    node->prev = NULL;
+    node->next = NULL;
+    node->count = 0;
+    return node;
+}
+
+static bool isValidIndex(const struct unrolledList* list, int index) {
+    if (index < 0 || index >= list->size) {
+        return false;
+    }
+
+    return true;
+}
+
+// Links node in after prev, or as the head if prev is NULL
+static void linkNodeAfter(struct unrolledList* list, struct unrolledNode* prev, struct unrolledNode* node) {
+    node->prev = prev;
+    node->next = prev != NULL ? prev->next : list->head;
+
+    if (node->next != NULL) {
+        node->next->prev = node;
+    } else {
+        list->tail = node;
+    }
+
+    if (prev != NULL) {
+        prev->next = node;
+    } else {
+        list->head = node;
+    }
+
+    list->nodeCount++;
+}
+
+static void unlinkNode(struct unrolledList* list, struct unrolledNode* node) {
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        list->head = node->next;
+    }
+
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    } else {
+        list->tail = node->prev;
+    }
+
+    list->nodeCount--;
+    free(node);
+}
+
+// Finds the node holding index (0 <= index < size), walking from whichever end is closer
+static struct unrolledNode* getNodeAt(const struct unrolledList* list, int index, int* offset) {
+    if (index < list->size / 2) {
+        struct unrolledNode* node = list->head;
+        while (index >= node->count) {
+            index -= node->count;
+            node = node->next;
+        }
+        *offset = index;
+        return node;
+    }
+
+    struct unrolledNode* node = list->tail;
+    int nodeStart = list->size - node->count;
+    while (index < nodeStart) {
+        node = node->prev;
+        nodeStart -= node->count;
+    }
+    *offset = index - nodeStart;
+    return node;
+}
+
+// Moves the upper half of a full node into a new node after it
+static void splitNode(struct unrolledList* list, struct unrolledNode* node) {
+    struct unrolledNode* second = newUnrolledNode();
+    const int keep = node->count / 2;
+
+    second->count = node->count - keep;
+    memcpy(second->data, node->data + keep, sizeof(int) * second->count);
+    node->count = keep;
+
+    linkNodeAfter(list, node, second);
+}
+
+// Inserts data so it ends up at index (0 <= index <= size)
+static void insertAt(struct unrolledList* list, int index, int data) {
+    struct unrolledNode* node;
+    int offset;
+
+    if (list->size == 0) {
+        node = newUnrolledNode();
+        linkNodeAfter(list, NULL, node);
+        offset = 0;
+    } else if (index == list->size) {
+        node = list->tail;
+        offset = node->count;
+    } else {
+        node = getNodeAt(list, index, &offset);
+    }
+
+    if (node->count == UNROLLED_NODE_CAPACITY) {
+        // Appending to a full tail starts a fresh node rather than leaving two half full ones
+        if (node == list->tail && offset == node->count) {
+            struct unrolledNode* next = newUnrolledNode();
+            linkNodeAfter(list, node, next);
+            node = next;
+            offset = 0;
+        } else {
+            splitNode(list, node);
+            if (offset > node->count) {
+                offset -= node->count;
+                node = node->next;
+            }
+        }
+    }
+
+    memmove(node->data + offset + 1, node->data + offset, sizeof(int) * (node->count - offset));
+    node->data[offset] = data;
+    node->count++;
+    list->size++;
+}
+
+static void removeAtOffset(struct unrolledList* list, struct unrolledNode* node, int offset) {
+    memmove(node->data + offset, node->data + offset + 1, sizeof(int) * (node->count - offset - 1));
+    node->count--;
+    list->size--;
+
+    if (node->count == 0) {
+        unlinkNode(list, node);
+        return;
+    }
+
+    // Keeps nodes dense so traversal doesn't degrade into one value per node
+    struct unrolledNode* next = node->next;
+    if (node->count < MERGE_THRESHOLD && next != NULL && node->count + next->count <= UNROLLED_NODE_CAPACITY) {
+        memcpy(node->data + node->count, next->data, sizeof(int) * next->count);
+        node->count += next->count;
+        unlinkNode(list, next);
+    }
+}
+
+void unrolledAddFirst(struct unrolledList* list, int data) {
+    insertAt(list, 0, data);
+}
+
+void unrolledAddBefore(struct unrolledList* list, int index, int data) {
+    if (!isValidIndex(list, index)) {
+        return;
+    }
+
+    insertAt(list, index, data);
+}
+
+void unrolledAddAfter(struct unrolledList* list, int index, int data) {
+    if (!isValidIndex(list, index)) {
+        return;
+    }
+
+    insertAt(list, index + 1, data);
+}
+
+void unrolledAddLast(struct unrolledList* list, int data) {
+    // Common case, room left in the tail
+    struct unrolledNode* tail = list->tail;
+    if (tail != NULL && tail->count < UNROLLED_NODE_CAPACITY) {
+        tail->data[tail->count++] = data;
+        list->size++;
+        return;
+    }
+
+    insertAt(list, list->size, data);
+}
+
+void unrolledRemoveFirst(struct unrolledList* list) {
+    if (list->head == NULL) {
+        return;
+    }
+
+    removeAtOffset(list, list->head, 0);
+}
+
+void unrolledRemoveAt(struct unrolledList* list, int index) {
+    if (!isValidIndex(list, index)) {
+        return;
+    }
+
+    int offset;
+    struct unrolledNode* node = getNodeAt(list, index, &offset);
+    removeAtOffset(list, node, offset);
+}
+
+void unrolledRemoveLast(struct unrolledList* list) {
+    if (list->tail == NULL) {
+        return;
+    }
+
+    removeAtOffset(list, list->tail, list->tail->count - 1);
+}
+
+int unrolledGetFirst(const struct unrolledList* list) {
+    if (list->head == NULL) {
+        return -1;
+    }
+
+    return list->head->data[0];
+}
+
+int unrolledGetAt(const struct unrolledList* list, int index) {
+    if (!isValidIndex(list, index)) {
+        return -1;
+    }
+
+    int offset;
+    const struct unrolledNode* node = getNodeAt(list, index, &offset);
+    return node->data[offset];
+}
+
+int unrolledGetLast(const struct unrolledList* list) {
+    if (list->tail == NULL) {
+        return -1;
+    }
+
+    return list->tail->data[list->tail->count - 1];
+}
+
+int unrolledFindIndexOfValue(const struct unrolledList* list, int data) {
+    int nodeStart = 0;
+
+    for (const struct unrolledNode* node = list->head; node != NULL; node = node->next) {
+        for (int i = 0; i < node->count; i++) {
+            if (node->data[i] == data) {
+                return nodeStart + i;
+            }
+        }
+        nodeStart += node->count;
+    }
+
+    return -1;
+}
+
+bool unrolledContainsValue(const struct unrolledList* list, int data) {
+    return unrolledFindIndexOfValue(list, data) != -1;
+}
+
+void unrolledReverseList(struct unrolledList* list) {
+    if (list->size < 2) {
+        return;
+    }
+
+    struct unrolledNode* curr = list->head;
+
+    while (curr != NULL) {
+        for (int l = 0, r = curr->count - 1; l < r; l++, r--) {
+            const int temp = curr->data[l];
+            curr->data[l] = curr->data[r];
+            curr->data[r] = temp;
+        }
+
+        struct unrolledNode* temp = curr->next;
+        curr->next = curr->prev;
+        curr->prev = temp;
+        curr = temp;
+    }
+
+    struct unrolledNode* temp = list->head;
+    list->head = list->tail;
+    list->tail = temp;
+}
+
+void freeUnrolledList(struct unrolledList* list) {
+    struct unrolledNode* node = list->head;
+
+    while (node != NULL) {
+        struct unrolledNode* temp = node;
+        node = node->next;
+        free(temp);
+    }
+
+    free(list);
+}
+
+void printUnrolledList(const struct unrolledList* list) {
+    printf("Printing list of size %i:\n", list->size);
+    for (const struct unrolledNode* node = list->head; node != NULL; node = node->next) {
+        for (int i = 0; i < node->count; i++) {
+            printf("%i", node->data[i]);
+            if (i + 1 < node->count || node->next != NULL) {
+                printf(" -> ");
+            }
+        }
+    }
+    printf("\nDone printing\n");
+}
\ No newline at end of file
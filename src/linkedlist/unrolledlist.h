@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+
+// Unrolled linked list, same operations as struct list but every node holds an array
+// of values, so walking it is mostly sequential reads instead of a cache miss per value.
+// Nodes are sized and aligned to two cache lines.
+
+#define UNROLLED_NODE_BYTES 128
+#define UNROLLED_NODE_CAPACITY ((int) ((UNROLLED_NODE_BYTES - 2 * sizeof(void*) - sizeof(int)) / sizeof(int)))
+
+struct unrolledNode {
+    struct unrolledNode* prev;
+    struct unrolledNode* next;
+    int count;
+    int data[UNROLLED_NODE_CAPACITY];
+};
+
+struct unrolledList {
+    int size;
+    int nodeCount;
+    struct unrolledNode* head;
+    struct unrolledNode* tail;
+};
+
+struct unrolledList* newUnrolledList();
+
+void unrolledAddFirst(struct unrolledList* list, int data);
+void unrolledAddBefore(struct unrolledList* list, int index, int data);
+void unrolledAddAfter(struct unrolledList* list, int index, int data);
+void unrolledAddLast(struct unrolledList* list, int data);
+
+void unrolledRemoveFirst(struct unrolledList* list);
+void unrolledRemoveAt(struct unrolledList* list, int index);
+void unrolledRemoveLast(struct unrolledList* list);
+
+int unrolledGetFirst(const struct unrolledList* list);
+int unrolledGetAt(const struct unrolledList* list, int index);
+int unrolledGetLast(const struct unrolledList* list);
+
+int unrolledFindIndexOfValue(const struct unrolledList* list, int data);
+bool unrolledContainsValue(const struct unrolledList* list, int data);
+void unrolledReverseList(struct unrolledList* list);
+
+void freeUnrolledList(struct unrolledList* list);
+void printUnrolledList(const struct unrolledList* list);
\ No newline at end of file
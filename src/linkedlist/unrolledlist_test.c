@@ -0,0 +1,129 @@
+// ReSharper disable CppLocalVariableMayBeConst
+#pragma once
+#include "unrolledlist.h"
+#include "linkedlist.h"
+#include <stdio.h>
+#include <assert.h>
+
+static void assertSameAsList(const struct unrolledList* unrolled, const struct list* list) {
+    assert(unrolled->size == list->size);
+
+    int index = 0;
+    for (const struct listEntry* entry = list->head; entry != NULL; entry = entry->next) {
+        assert(unrolledGetAt(unrolled, index) == entry->data);
+        index++;
+    }
+}
+
+void testUnrolledListImpl() {
+    printf("=== Unrolled List Comprehensive Test ===\n\n");
+
+    // Test 1: Create new list and check initial state
+    printf("Test 1: Creating new unrolled list\n");
+    struct unrolledList* myList = newUnrolledList();
+    assert(myList != NULL);
+    assert(myList->size == 0);
+    assert(myList->head == NULL);
+    assert(myList->tail == NULL);
+    assert(unrolledGetAt(myList, 0) == -1);
+    printf("✓ New unrolled list created successfully\n\n");
+
+    // Test 2: Same sequence of operations as the linked list test
+    printf("Test 2: Adding and removing at both ends and by index\n");
+    unrolledAddFirst(myList, 10);
+    unrolledAddFirst(myList, 20);
+    unrolledAddLast(myList, 30);
+    unrolledAddLast(myList, 40);
+    unrolledAddBefore(myList, 0, 15);
+    unrolledAddBefore(myList, 2, 25);
+    unrolledAddAfter(myList, 0, 18);
+    unrolledAddAfter(myList, myList->size - 1, 45);
+    assert(myList->size == 8);
+    assert(unrolledGetFirst(myList) == 15);
+    assert(unrolledGetAt(myList, 1) == 18);
+    assert(unrolledGetAt(myList, 3) == 25);
+    assert(unrolledGetLast(myList) == 45);
+    assert(unrolledContainsValue(myList, 25) == true);
+    assert(unrolledContainsValue(myList, 99) == false);
+    assert(unrolledFindIndexOfValue(myList, 30) == 5);
+
+    unrolledRemoveFirst(myList);
+    unrolledRemoveLast(myList);
+    unrolledRemoveAt(myList, 2);
+    assert(myList->size == 5);
+    assert(unrolledGetFirst(myList) == 18);
+    assert(unrolledGetLast(myList) == 40);
+    printUnrolledList(myList);
+
+    unrolledReverseList(myList);
+    assert(unrolledGetFirst(myList) == 40);
+    assert(unrolledGetLast(myList) == 18);
+    printf("✓ Basic operations working correctly\n\n");
+
+    // Test 3: Empty list edge cases
+    printf("Test 3: Testing edge cases\n");
+    struct unrolledList* emptyList = newUnrolledList();
+    unrolledRemoveFirst(emptyList);
+    unrolledRemoveLast(emptyList);
+    unrolledRemoveAt(emptyList, 0);
+    unrolledAddBefore(emptyList, 0, 1);
+    assert(emptyList->size == 0);
+    unrolledAddLast(emptyList, 200);
+    assert(unrolledGetFirst(emptyList) == 200);
+    unrolledRemoveLast(emptyList);
+    assert(emptyList->size == 0);
+    assert(emptyList->head == NULL);
+    printf("✓ Edge cases handled correctly\n\n");
+
+    // Test 4: Values are packed into nodes
+    printf("Test 4: Testing node packing\n");
+    struct unrolledList* packed = newUnrolledList();
+    for (int i = 0; i < 10 * UNROLLED_NODE_CAPACITY; i++) {
+        unrolledAddLast(packed, i);
+    }
+    assert(packed->nodeCount == 10);
+    for (int i = 0; i < 10 * UNROLLED_NODE_CAPACITY; i++) {
+        assert(unrolledGetAt(packed, i) == i);
+    }
+    printf("✓ Nodes are filled before new ones are added\n\n");
+
+    // Test 5: Random operations give the same result as struct list
+    printf("Test 5: Comparing random operations against struct list\n");
+    struct unrolledList* unrolled = newUnrolledList();
+    struct list* reference = newList();
+    unsigned int seed = 42;
+
+    for (int i = 0; i < 20000; i++) {
+        seed = seed * 1103515245 + 12345;
+        const int operation = (int) ((seed >> 16) % 8);
+        const int index = reference->size > 0 ? (int) ((seed >> 8) % (unsigned int) reference->size) : 0;
+
+        switch (operation) {
+            case 0: addFirst(reference, i); unrolledAddFirst(unrolled, i); break;
+            case 1: addLast(reference, i); unrolledAddLast(unrolled, i); break;
+            case 2: addBefore(reference, index, i); unrolledAddBefore(unrolled, index, i); break;
+            case 3: addAfter(reference, index, i); unrolledAddAfter(unrolled, index, i); break;
+            case 4: removeFirst(reference); unrolledRemoveFirst(unrolled); break;
+            case 5: removeLast(reference); unrolledRemoveLast(unrolled); break;
+            case 6: removeAt(reference, index); unrolledRemoveAt(unrolled, index); break;
+            default:
+                if (reference->size > 0) {
+                    assert(unrolledGetAt(unrolled, index) == getAt(reference, index));
+                }
+                break;
+        }
+    }
+    assertSameAsList(unrolled, reference);
+
+    reverseList(reference);
+    unrolledReverseList(unrolled);
+    assertSameAsList(unrolled, reference);
+    printf("✓ Unrolled list matches struct list\n\n");
+
+    freeUnrolledList(myList);
+    freeUnrolledList(emptyList);
+    freeUnrolledList(packed);
+    freeUnrolledList(unrolled);
+    freeList(reference);
+    printf("✓ All tests passed! Your unrolled list implementation is working correctly.\n");
+}
\ No newline at end of file
@@ -1,7 +1,47 @@
+// The tests are all asserts, keep them on in release builds too
+#undef NDEBUG
+// Tests use POSIX calls (fork, rand_r, strdup), declare them under a strict -std=c17 too
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
-#include "allocation/allocation.h"
+#include <string.h>
+#include "bench/benchmarks.h"
+#include "allocation/allocation_test.c"
+#include "allocation/allocator_test.c"
+#include "cache/lru_cache_test.c"
+#include "hashmap/hashmap_test.c"
+#include "linkedlist/intrusivelist_test.c"
+#include "linkedlist/linkedlist_test.c"
+#include "linkedlist/unrolledlist_test.c"
+#include "queue/mpmc_queue_test.c"
+#include "vector/vector_test.c"
 
-int main() {
-    my_malloc(25);
-    return 0;
-}
\ No newline at end of file
+static void runAllTests() {
+    testAllocation();
+    testAllocator();
+    testHashMapImpl();
+    testLinkedListImpl();
+    testLinkedListIterator();
+    testLinkedListSkipIndex();
+    testLinkedListPool();
+    testLinkedListSpliceSortSplit();
+    testLinkedListExport();
+    testUnrolledListImpl();
+    testIntrusiveList();
+    testMpmcQueue();
+    testLruCache();
+    runAllVectorTests();
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return run_benchmarks(argc - 2, argv + 2);
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "test") == 0) {
+        runAllTests();
+        return 0;
+    }
+
+    fprintf(stderr, "usage: cstuff test\n       cstuff bench [--help | options]\n");
+    return 1;
+}
@@ -0,0 +1,127 @@
+#include "mpmc_queue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+struct mpmc_queue* mpmc_queue_new(int capacity) {
+    size_t rounded = 2;
+    while (rounded < (size_t) capacity) {
+        rounded *= 2;
+    }
+
+    struct mpmc_queue* queue = aligned_alloc(64, sizeof(struct mpmc_queue));
+    queue->cells = malloc(sizeof(struct mpmc_queue_cell) * rounded);
+    if (queue->cells == NULL) {
+        printf("failed to malloc");
+        exit(1);
+    }
+    queue->mask = rounded - 1;
+
+    // Cell i is free for the producer at position i
+    for (size_t i = 0; i < rounded; i++) {
+        atomic_init(&queue->cells[i].sequence, i);
+    }
+    atomic_init(&queue->enqueue_position, 0);
+    atomic_init(&queue->dequeue_position, 0);
+    return queue;
+}
+
+void mpmc_queue_free(struct mpmc_queue* queue) {
+    free(queue->cells);
+    free(queue);
+}
+
+// How many cells from position on are ready, a cell is ready when its sequence is position + i + offset
+// (offset 0 means free for a producer, 1 means filled for a consumer). Stops at the first one that isn't.
+static int count_ready(const struct mpmc_queue* queue, size_t position, size_t offset, int max_count) {
+    int ready = 0;
+    while (ready < max_count) {
+        const struct mpmc_queue_cell* cell = &queue->cells[(position + ready) & queue->mask];
+        const size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        if (sequence != position + ready + offset) {
+            break;
+        }
+        ready++;
+    }
+    return ready;
+}
+
+// Claims up to max_count ready cells by moving counter past them, returns how many and where they start.
+// Cells ahead of the counter can't stop being ready until the counter moves past them, so if the
+// CAS succeeds every cell counted is still ours.
+static int claim(struct mpmc_queue* queue, atomic_size_t* counter, size_t offset, int max_count, size_t* start) {
+    size_t position = atomic_load_explicit(counter, memory_order_relaxed);
+
+    for (;;) {
+        const int ready = count_ready(queue, position, offset, max_count);
+
+        if (ready == 0) {
+            const struct mpmc_queue_cell* cell = &queue->cells[position & queue->mask];
+            const size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+
+            // Behind position means the cell is still a lap behind, so the queue is full (or empty)
+            if ((ptrdiff_t) (sequence - (position + offset)) < 0) {
+                return 0;
+            }
+
+            // Someone else claimed it, try again from where they got to
+            position = atomic_load_explicit(counter, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(counter, &position, position + ready,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            *start = position;
+            return ready;
+        }
+    }
+}
+
+int mpmc_queue_enqueue_batch(struct mpmc_queue* queue, const int* values, int count) {
+    if (count <= 0) {
+        return 0;
+    }
+
+    size_t start;
+    const int claimed = claim(queue, &queue->enqueue_position, 0, count, &start);
+
+    for (int i = 0; i < claimed; i++) {
+        struct mpmc_queue_cell* cell = &queue->cells[(start + i) & queue->mask];
+        cell->value = values[i];
+        atomic_store_explicit(&cell->sequence, start + i + 1, memory_order_release);
+    }
+
+    return claimed;
+}
+
+int mpmc_queue_dequeue_batch(struct mpmc_queue* queue, int* out, int max_count) {
+    if (max_count <= 0) {
+        return 0;
+    }
+
+    size_t start;
+    const int claimed = claim(queue, &queue->dequeue_position, 1, max_count, &start);
+
+    for (int i = 0; i < claimed; i++) {
+        struct mpmc_queue_cell* cell = &queue->cells[(start + i) & queue->mask];
+        out[i] = cell->value;
+        // Free for the producer one lap later
+        atomic_store_explicit(&cell->sequence, start + i + queue->mask + 1, memory_order_release);
+    }
+
+    return claimed;
+}
+
+bool mpmc_queue_enqueue(struct mpmc_queue* queue, int value) {
+    return mpmc_queue_enqueue_batch(queue, &value, 1) == 1;
+}
+
+bool mpmc_queue_dequeue(struct mpmc_queue* queue, int* out) {
+    return mpmc_queue_dequeue_batch(queue, out, 1) == 1;
+}
+
+int mpmc_queue_size(const struct mpmc_queue* queue) {
+    const size_t enqueued = atomic_load_explicit(&queue->enqueue_position, memory_order_relaxed);
+    const size_t dequeued = atomic_load_explicit(&queue->dequeue_position, memory_order_relaxed);
+    return enqueued > dequeued ? (int) (enqueued - dequeued) : 0;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Bounded lock-free queue that any number of threads can enqueue to and dequeue from at
+// once (Vyukov's array queue). Every cell carries a sequence number saying whose turn it
+// is, so producers and consumers only contend on one counter each and never on a lock.
+// Meant to replace a mutex guarded struct list used as a work queue.
+
+struct mpmc_queue_cell {
+    atomic_size_t sequence;
+    int value;
+};
+
+struct mpmc_queue {
+    size_t mask; // capacity - 1, capacity is a power of two
+    struct mpmc_queue_cell* cells;
+    // Kept on their own cache lines so producers and consumers don't bounce each other's
+    alignas(64) atomic_size_t enqueue_position;
+    alignas(64) atomic_size_t dequeue_position;
+};
+
+// capacity is rounded up to a power of two
+struct mpmc_queue* mpmc_queue_new(int capacity);
+void mpmc_queue_free(struct mpmc_queue* queue);
+
+// False if the queue is full
+bool mpmc_queue_enqueue(struct mpmc_queue* queue, int value);
+// False if the queue is empty
+bool mpmc_queue_dequeue(struct mpmc_queue* queue, int* out);
+
+// Claims as many consecutive slots as are free (up to count) in one step, returns how many were enqueued
+int mpmc_queue_enqueue_batch(struct mpmc_queue* queue, const int* values, int count);
+// Takes up to max_count values in one step, returns how many were dequeued
+int mpmc_queue_dequeue_batch(struct mpmc_queue* queue, int* out, int max_count);
+
+// Only a snapshot while other threads are using the queue
+int mpmc_queue_size(const struct mpmc_queue* queue);
\ No newline at end of file
@@ -0,0 +1,169 @@
+// ReSharper disable CppLocalVariableMayBeConst
+#pragma once
+#include "mpmc_queue.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+
+#define MPMC_TEST_PRODUCERS 4
+#define MPMC_TEST_CONSUMERS 4
+#define MPMC_TEST_VALUES_PER_PRODUCER 50000
+
+struct mpmc_test_args {
+    struct mpmc_queue* queue;
+    int thread_index;
+    atomic_int* consumed;
+    atomic_llong* sum;
+    int* seen;
+};
+
+static void* mpmc_test_produce(void* arg) {
+    const struct mpmc_test_args* args = arg;
+    const int base = args->thread_index * MPMC_TEST_VALUES_PER_PRODUCER;
+
+    // Half one at a time, half in batches
+    for (int i = 0; i < MPMC_TEST_VALUES_PER_PRODUCER / 2; i++) {
+        while (!mpmc_queue_enqueue(args->queue, base + i)) {
+            sched_yield();
+        }
+    }
+
+    int batch[16];
+    for (int i = MPMC_TEST_VALUES_PER_PRODUCER / 2; i < MPMC_TEST_VALUES_PER_PRODUCER;) {
+        int count = 0;
+        while (count < 16 && i + count < MPMC_TEST_VALUES_PER_PRODUCER) {
+            batch[count] = base + i + count;
+            count++;
+        }
+
+        int enqueued = 0;
+        while (enqueued < count) {
+            const int added = mpmc_queue_enqueue_batch(args->queue, batch + enqueued, count - enqueued);
+            if (added == 0) {
+                sched_yield();
+            }
+            enqueued += added;
+        }
+        i += count;
+    }
+    return NULL;
+}
+
+static void* mpmc_test_consume(void* arg) {
+    const struct mpmc_test_args* args = arg;
+    const int total = MPMC_TEST_PRODUCERS * MPMC_TEST_VALUES_PER_PRODUCER;
+
+    int batch[8];
+    while (atomic_load(args->consumed) < total) {
+        int count;
+        if (args->thread_index % 2 == 0) {
+            count = mpmc_queue_dequeue(args->queue, batch) ? 1 : 0;
+        } else {
+            count = mpmc_queue_dequeue_batch(args->queue, batch, 8);
+        }
+
+        if (count == 0) {
+            sched_yield();
+        }
+
+        for (int i = 0; i < count; i++) {
+            assert(batch[i] >= 0 && batch[i] < total);
+            args->seen[batch[i]]++;
+            atomic_fetch_add(args->sum, batch[i]);
+        }
+        atomic_fetch_add(args->consumed, count);
+    }
+    return NULL;
+}
+
+void testMpmcQueue() {
+    printf("=== MPMC Queue Test ===\n\n");
+
+    // Test 1: Single threaded, filling up and draining
+    printf("Test 1: Full and empty queue\n");
+    struct mpmc_queue* queue = mpmc_queue_new(5);
+    assert(queue->mask == 7);
+
+    int out = -1;
+    assert(!mpmc_queue_dequeue(queue, &out));
+    for (int i = 0; i < 8; i++) {
+        assert(mpmc_queue_enqueue(queue, i));
+    }
+    assert(!mpmc_queue_enqueue(queue, 8));
+    assert(mpmc_queue_size(queue) == 8);
+
+    for (int i = 0; i < 8; i++) {
+        assert(mpmc_queue_dequeue(queue, &out));
+        assert(out == i);
+    }
+    assert(!mpmc_queue_dequeue(queue, &out));
+    assert(mpmc_queue_size(queue) == 0);
+    printf("✓ Full and empty queue working correctly\n\n");
+
+    // Test 2: Batches stop at whatever room or values there are
+    printf("Test 2: Batches\n");
+    int values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    assert(mpmc_queue_enqueue_batch(queue, values, 5) == 5);
+    assert(mpmc_queue_enqueue_batch(queue, values + 5, 5) == 3);
+
+    int drained[10];
+    assert(mpmc_queue_dequeue_batch(queue, drained, 3) == 3);
+    assert(drained[0] == 0 && drained[2] == 2);
+    assert(mpmc_queue_dequeue_batch(queue, drained, 10) == 5);
+    assert(drained[0] == 3 && drained[4] == 7);
+    assert(mpmc_queue_dequeue_batch(queue, drained, 10) == 0);
+
+    // Wrapping around the end of the cells
+    for (int lap = 0; lap < 5; lap++) {
+        assert(mpmc_queue_enqueue_batch(queue, values, 6) == 6);
+        assert(mpmc_queue_dequeue_batch(queue, drained, 6) == 6);
+        for (int i = 0; i < 6; i++) {
+            assert(drained[i] == i);
+        }
+    }
+    mpmc_queue_free(queue);
+    printf("✓ Batches working correctly\n\n");
+
+    // Test 3: Many producers and consumers, every value comes out exactly once
+    printf("Test 3: Producers and consumers on a small queue\n");
+    queue = mpmc_queue_new(64);
+    const int total = MPMC_TEST_PRODUCERS * MPMC_TEST_VALUES_PER_PRODUCER;
+    atomic_int consumed = 0;
+    atomic_llong sum = 0;
+    int* seen = calloc(total, sizeof(int));
+
+    pthread_t producers[MPMC_TEST_PRODUCERS];
+    pthread_t consumers[MPMC_TEST_CONSUMERS];
+    struct mpmc_test_args producerArgs[MPMC_TEST_PRODUCERS];
+    struct mpmc_test_args consumerArgs[MPMC_TEST_CONSUMERS];
+
+    for (int i = 0; i < MPMC_TEST_CONSUMERS; i++) {
+        consumerArgs[i] = (struct mpmc_test_args) {queue, i, &consumed, &sum, seen};
+        pthread_create(&consumers[i], NULL, mpmc_test_consume, &consumerArgs[i]);
+    }
+    for (int i = 0; i < MPMC_TEST_PRODUCERS; i++) {
+        producerArgs[i] = (struct mpmc_test_args) {queue, i, &consumed, &sum, seen};
+        pthread_create(&producers[i], NULL, mpmc_test_produce, &producerArgs[i]);
+    }
+    for (int i = 0; i < MPMC_TEST_PRODUCERS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    for (int i = 0; i < MPMC_TEST_CONSUMERS; i++) {
+        pthread_join(consumers[i], NULL);
+    }
+
+    assert(consumed == total);
+    assert(sum == (long long) total * (total - 1) / 2);
+    for (int i = 0; i < total; i++) {
+        assert(seen[i] == 1);
+    }
+    assert(mpmc_queue_size(queue) == 0);
+
+    free(seen);
+    mpmc_queue_free(queue);
+    printf("✓ Producers and consumers working correctly\n\n");
+
+    printf("✓ All MPMC queue tests passed!\n");
+}
\ No newline at end of file
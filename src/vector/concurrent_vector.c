@@ -0,0 +1,124 @@
+#include "concurrent_vector.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIRST_SEGMENT_SIZE (1 << CONCURRENT_VECTOR_FIRST_SEGMENT_BITS)
+
+// Segment k holds FIRST_SEGMENT_SIZE << k elements and starts at index FIRST_SEGMENT_SIZE * (2^k - 1)
+static int get_segment_index(int index) {
+    const unsigned int scaled = ((unsigned int) index >> CONCURRENT_VECTOR_FIRST_SEGMENT_BITS) + 1;
+    return 31 - __builtin_clz(scaled);
+}
+
+static int get_segment_start(int segment) {
+    return FIRST_SEGMENT_SIZE * ((1 << segment) - 1);
+}
+
+static int get_segment_size(int segment) {
+    return FIRST_SEGMENT_SIZE << segment;
+}
+
+struct concurrent_vector* concurrent_vector_new() {
+    struct concurrent_vector* vector = malloc(sizeof(struct concurrent_vector));
+    atomic_init(&vector->size, 0);
+    for (int i = 0; i < CONCURRENT_VECTOR_MAX_SEGMENTS; i++) {
+        atomic_init(&vector->segments[i], NULL);
+    }
+    return vector;
+}
+
+void concurrent_vector_free(struct concurrent_vector* vector) {
+    for (int i = 0; i < CONCURRENT_VECTOR_MAX_SEGMENTS; i++) {
+        free(atomic_load_explicit(&vector->segments[i], memory_order_relaxed));
+    }
+    free(vector);
+}
+
+// The first thread to need a segment allocates it, racing threads that lose the CAS free theirs
+static vector_type* get_or_allocate_segment(struct concurrent_vector* vector, int segment) {
+    vector_type* existing = atomic_load_explicit(&vector->segments[segment], memory_order_acquire);
+    if (existing != NULL) {
+        return existing;
+    }
+
+    vector_type* allocated = malloc(sizeof(vector_type) * get_segment_size(segment));
+    if (allocated == NULL) {
+        printf("failed to malloc");
+        exit(1);
+    }
+
+    if (atomic_compare_exchange_strong_explicit(&vector->segments[segment], &existing, allocated,
+                                                memory_order_acq_rel, memory_order_acquire)) {
+        return allocated;
+    }
+
+    free(allocated);
+    return existing;
+}
+
+// The last segment would only be partly addressable by an int, so it's never used
+static int reserve(struct concurrent_vector* vector, int count) {
+    const int index = atomic_fetch_add_explicit(&vector->size, count, memory_order_relaxed);
+    if (index < 0 || (long long) index + count > get_segment_start(CONCURRENT_VECTOR_MAX_SEGMENTS - 1)) {
+        printf("concurrent_vector: too many elements");
+        exit(1);
+    }
+    return index;
+}
+
+int concurrent_vector_push(struct concurrent_vector* vector, vector_type value) {
+    const int index = reserve(vector, 1);
+    const int segment = get_segment_index(index);
+
+    vector_type* elements = get_or_allocate_segment(vector, segment);
+    elements[index - get_segment_start(segment)] = value;
+    return index;
+}
+
+int concurrent_vector_append(struct concurrent_vector* vector, const vector_type* src, int count) {
+    if (count <= 0) {
+        return atomic_load_explicit(&vector->size, memory_order_relaxed);
+    }
+
+    const int first_index = reserve(vector, count);
+
+    // The reserved range can span several segments, copy the piece that lands in each one
+    int index = first_index;
+    int copied = 0;
+    while (copied < count) {
+        const int segment = get_segment_index(index);
+        const int offset = index - get_segment_start(segment);
+        int chunk = get_segment_size(segment) - offset;
+        if (chunk > count - copied) {
+            chunk = count - copied;
+        }
+
+        vector_type* elements = get_or_allocate_segment(vector, segment);
+        memcpy(elements + offset, src + copied, sizeof(vector_type) * chunk);
+
+        index += chunk;
+        copied += chunk;
+    }
+
+    return first_index;
+}
+
+int concurrent_vector_size(const struct concurrent_vector* vector) {
+    return atomic_load_explicit(&vector->size, memory_order_acquire);
+}
+
+vector_type* concurrent_vector_at(const struct concurrent_vector* vector, int index) {
+    if (index < 0 || index >= concurrent_vector_size(vector)) {
+        return NULL;
+    }
+
+    const int segment = get_segment_index(index);
+    vector_type* elements = atomic_load_explicit(&vector->segments[segment], memory_order_acquire);
+    if (elements == NULL) {
+        return NULL;
+    }
+
+    return &elements[index - get_segment_start(segment)];
+}
\ No newline at end of file
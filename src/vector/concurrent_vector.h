@@ -0,0 +1,29 @@
+#pragma once
+#include <stdatomic.h>
+#include "vector.h"
+
+// Append only vector that many threads can push to at once without locking.
+// Storage is a list of segments that double in size and are never moved or freed
+// until concurrent_vector_free, so pointers from concurrent_vector_at stay valid
+// while other threads keep pushing.
+
+#define CONCURRENT_VECTOR_FIRST_SEGMENT_BITS 5 // first segment holds 32 elements
+#define CONCURRENT_VECTOR_MAX_SEGMENTS (32 - CONCURRENT_VECTOR_FIRST_SEGMENT_BITS)
+
+struct concurrent_vector {
+    atomic_int size; // indices handed out, including pushes still writing their element
+    _Atomic(vector_type*) segments[CONCURRENT_VECTOR_MAX_SEGMENTS];
+};
+
+struct concurrent_vector* concurrent_vector_new();
+void concurrent_vector_free(struct concurrent_vector* vector);
+
+// Returns the index the value was stored at
+int concurrent_vector_push(struct concurrent_vector* vector, vector_type value);
+// Reserves count consecutive indices and copies src into them, returns the first index
+int concurrent_vector_append(struct concurrent_vector* vector, const vector_type* src, int count);
+
+int concurrent_vector_size(const struct concurrent_vector* vector);
+// An element is only safe to read once the push that stored it has returned (and that is visible
+// to this thread, eg. through a join or some other synchronization), NULL if index isn't reserved yet
+vector_type* concurrent_vector_at(const struct concurrent_vector* vector, int index);
\ No newline at end of file
@@ -1,37 +1,202 @@
 #include "vector.h"
+#include "vector_internal.h"
+#include "../allocation/allocator.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define INITIAL_CAPACITY 8
+#define INITIAL_CAPACITY VECTOR_INLINE_CAPACITY
 
-struct vector* vector_new() {
-    struct vector* vector = malloc(sizeof(struct vector));
+void vector_init(struct vector* vector) {
+    vector_init_with_allocator(vector, &allocator_libc);
+}
+
+void vector_init_with_allocator(struct vector* vector, const struct allocator* allocator) {
     vector->size = 0;
     vector->capacity = INITIAL_CAPACITY;
     vector->is_wrapping = false;
-    vector->head = malloc(sizeof(vector_type) * INITIAL_CAPACITY);
+    vector->mapping = NULL;
+    vector->shared = NULL;
+    vector->growth_factor = VECTOR_GROWTH_FACTOR_DEFAULT;
+    vector->shrink_policy = VECTOR_SHRINK_NEVER;
+    vector->allocator = allocator;
+    vector->head = vector->inline_buffer;
+}
+
+static size_t get_buffer_bytes(const struct vector* vector) {
+    return sizeof(vector_type) * vector->capacity;
+}
+
+// Drops this vector's reference to a shared buffer, freeing it if it was the last one
+static void vector_release_shared(struct vector* vector) {
+    struct vector_shared* shared = vector->shared;
+    vector->shared = NULL;
+
+    if (atomic_fetch_sub(&shared->ref_count, 1) == 1) {
+        allocator_free(vector->allocator, vector->head, get_buffer_bytes(vector));
+        allocator_free(vector->allocator, shared, sizeof(struct vector_shared));
+    }
+}
+
+void vector_destroy(struct vector* vector) {
+    if (vector->mapping != NULL) {
+        vector_mmap_close(vector);
+    } else if (vector->shared != NULL) {
+        vector_release_shared(vector);
+    } else if (!vector->is_wrapping && vector->head != vector->inline_buffer) {
+        allocator_free(vector->allocator, vector->head, get_buffer_bytes(vector));
+    }
+    vector->head = vector->inline_buffer;
+    vector->size = 0;
+    vector->capacity = INITIAL_CAPACITY;
+    vector->is_wrapping = false;
+}
+
+struct vector* vector_new() {
+    return vector_new_with_allocator(&allocator_libc);
+}
+
+struct vector* vector_new_with_allocator(const struct allocator* allocator) {
+    struct vector* vector = allocator_malloc(allocator, sizeof(struct vector));
+    vector_init_with_allocator(vector, allocator);
     return vector;
 }
 
 void vector_free(struct vector* vector) {
-    if (!vector->is_wrapping) {
-        free(vector->head);
+    vector_destroy(vector);
+    allocator_free(vector->allocator, vector, sizeof(struct vector));
+}
+
+// Moves the elements into a buffer of exactly new_capacity (new_capacity >= size)
+// Small capacities go back into the inline buffer, wrapped arrays are copied out since we can't realloc them
+static void vector_set_capacity(struct vector* vector, int new_capacity) {
+    if (vector->mapping != NULL) {
+        vector_mmap_set_capacity(vector, new_capacity);
+        return;
     }
-    free(vector);
+
+    vector_prepare_write(vector);
+
+    const bool is_inline = vector->head == vector->inline_buffer;
+    const bool is_owned_heap = !is_inline && !vector->is_wrapping;
+
+    if (new_capacity <= VECTOR_INLINE_CAPACITY) {
+        if (!is_inline) {
+            if (vector->size > 0) {
+                memmove(vector->inline_buffer, vector->head, sizeof(vector_type) * vector->size);
+            }
+            if (is_owned_heap) {
+                allocator_free(vector->allocator, vector->head, get_buffer_bytes(vector));
+            }
+            vector->head = vector->inline_buffer;
+            vector->is_wrapping = false;
+        }
+        vector->capacity = VECTOR_INLINE_CAPACITY;
+        return;
+    }
+
+    vector_type* new_ptr;
+    if (is_owned_heap) {
+        new_ptr = allocator_realloc(vector->allocator, vector->head, get_buffer_bytes(vector),
+                                    sizeof(vector_type) * new_capacity);
+    } else {
+        new_ptr = allocator_malloc(vector->allocator, sizeof(vector_type) * new_capacity);
+        if (vector->size > 0) {
+            memcpy(new_ptr, vector->head, sizeof(vector_type) * vector->size);
+        }
+    }
+
+    vector->head = new_ptr;
+    vector->capacity = new_capacity;
+    vector->is_wrapping = false;
+}
+
+// Smallest capacity reachable by repeatedly applying the growth factor that fits min_capacity
+static int vector_grown_capacity(const struct vector* vector, int min_capacity) {
+    int capacity = vector->capacity > 0 ? vector->capacity : 1;
+
+    while (capacity < min_capacity) {
+        // In double and clamped, capacity * growth_factor passes INT_MAX around a billion elements
+        const double grown = (double) capacity * vector->growth_factor;
+        int next = grown >= (double) INT_MAX ? INT_MAX : (int) grown;
+        if (next <= capacity) {
+            next = capacity + 1;
+        }
+        capacity = next;
+    }
+
+    return capacity;
+}
+
+void vector_set_growth_factor(struct vector* vector, double growth_factor) {
+    if (growth_factor <= 1.0) {
+        return;
+    }
+    vector->growth_factor = growth_factor;
+}
+
+void vector_reserve(struct vector* vector, int capacity) {
+    if (capacity <= vector->capacity) {
+        return;
+    }
+    vector_set_capacity(vector, capacity);
+}
+
+void vector_shrink_to_fit(struct vector* vector) {
+    if (vector->is_wrapping || vector->capacity == vector->size || vector->capacity <= VECTOR_INLINE_CAPACITY) {
+        return;
+    }
+    vector_set_capacity(vector, vector->size);
+}
+
+void vector_set_shrink_policy(struct vector* vector, enum vector_shrink_policy shrink_policy) {
+    vector->shrink_policy = shrink_policy;
+}
+
+// Halving only once size is at a quarter leaves the vector half full, so it takes
+// capacity / 4 pops to shrink again or capacity / 2 pushes to grow again
+static int vector_trimmed_capacity(const struct vector* vector) {
+    int capacity = vector->capacity;
+    while (vector->size <= capacity / 4 && capacity / 2 >= INITIAL_CAPACITY) {
+        capacity /= 2;
+    }
+    return capacity;
+}
+
+void vector_trim(struct vector* vector) {
+    if (vector->is_wrapping) {
+        return;
+    }
+
+    const int new_capacity = vector_trimmed_capacity(vector);
+    if (new_capacity != vector->capacity) {
+        vector_set_capacity(vector, new_capacity);
+    }
+}
+
+static void vector_ensure_capacity(struct vector* vector, int min_capacity) {
+    if (min_capacity > vector->capacity) {
+        vector_set_capacity(vector, vector_grown_capacity(vector, min_capacity));
+    }
+}
+
+// Growing can move the buffer, so a source range pointing into the vector itself is tracked by offset
+static const vector_type* vector_ensure_capacity_for(struct vector* vector, int min_capacity, const vector_type* src) {
+    const bool is_self = src >= vector->head && src < vector->head + vector->size;
+    const long offset = is_self ? src - vector->head : 0;
+
+    vector_prepare_write(vector);
+    vector_ensure_capacity(vector, min_capacity);
+
+    return is_self ? vector->head + offset : src;
 }
 
 void vector_push(struct vector* vector, vector_type value) {
+    vector_prepare_write(vector);
     if (vector->size >= vector->capacity) {
-        const int new_capacity = vector->capacity * 2;
-        vector_type* new_ptr = realloc(vector->head, sizeof(vector_type) * new_capacity);
-        if (new_ptr == NULL) {
-            printf("failed to realloc");
-            exit(1);
-        }
-        vector->head = new_ptr;
-        vector->capacity = new_capacity;
+        vector_ensure_capacity(vector, vector->size + 1);
     }
 
     const int index = vector->size;
@@ -49,18 +214,13 @@ struct vector_type_nullable vector_pop(struct vector* vector) {
     return_data.is_null = false;
     return_data.data = vector->head[index];
 
-    if (vector->size <= vector->capacity / 4) {
-        const int new_capacity = vector->capacity / 2;
-        if (new_capacity >= INITIAL_CAPACITY) {
-            vector_type* new_ptr = realloc(vector->head, sizeof(vector_type) * new_capacity);
-            if (new_ptr != NULL) {
-                vector->head = new_ptr;
-                vector->capacity = new_capacity;
-            }
-        }
+    vector_prepare_write(vector);
+    vector->size--;
+
+    if (vector->shrink_policy == VECTOR_SHRINK_HYSTERESIS && vector->size <= vector->capacity / 4) {
+        vector_trim(vector);
     }
 
-    vector->size--;
     return return_data;
 }
 
@@ -72,8 +232,86 @@ vector_type* vector_at(const struct vector* vector, int index) {
     return &vector->head[index];
 }
 
+void vector_append(struct vector* vector, const vector_type* src, int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    src = vector_ensure_capacity_for(vector, vector->size + count, src);
+    memcpy(vector->head + vector->size, src, sizeof(vector_type) * count);
+    vector->size += count;
+}
+
+void vector_extend(struct vector* vector, const struct vector* other) {
+    vector_append(vector, other->head, other->size);
+}
+
+bool vector_insert_range(struct vector* vector, int index, const vector_type* src, int count) {
+    if (index < 0 || index > vector->size) {
+        return false;
+    }
+    if (count <= 0) {
+        return true;
+    }
+
+    src = vector_ensure_capacity_for(vector, vector->size + count, src);
+
+    // The source may sit in the part that's about to be shifted, so copy it out of the way first
+    vector_type* gap = vector->head + index;
+    const bool overlaps = src + count > gap && src < vector->head + vector->size;
+    vector_type* src_copy = NULL;
+    if (overlaps) {
+        src_copy = allocator_malloc(vector->allocator, sizeof(vector_type) * count);
+        memcpy(src_copy, src, sizeof(vector_type) * count);
+        src = src_copy;
+    }
+
+    memmove(gap + count, gap, sizeof(vector_type) * (vector->size - index));
+    memcpy(gap, src, sizeof(vector_type) * count);
+    vector->size += count;
+
+    allocator_free(vector->allocator, src_copy, sizeof(vector_type) * count);
+    return true;
+}
+
+bool vector_erase_range(struct vector* vector, int begin, int end) {
+    if (begin < 0 || end > vector->size || begin > end) {
+        return false;
+    }
+    if (begin == end) {
+        return true;
+    }
+
+    vector_prepare_write(vector);
+    memmove(vector->head + begin, vector->head + end, sizeof(vector_type) * (vector->size - end));
+    vector->size -= end - begin;
+
+    if (vector->shrink_policy == VECTOR_SHRINK_HYSTERESIS && vector->size <= vector->capacity / 4) {
+        vector_trim(vector);
+    }
+    return true;
+}
+
+void vector_resize(struct vector* vector, int size, vector_type fill) {
+    if (size < 0) {
+        return;
+    }
+
+    if (size <= vector->size) {
+        vector_erase_range(vector, size, vector->size);
+        return;
+    }
+
+    vector_prepare_write(vector);
+    vector_ensure_capacity(vector, size);
+    for (int i = vector->size; i < size; i++) {
+        vector->head[i] = fill;
+    }
+    vector->size = size;
+}
+
 struct vector* vector_wrap_array(int size, vector_type* head) {
-    struct vector* vector = malloc(sizeof(struct vector));
+    struct vector* vector = vector_new();
     vector->size = size;
     vector->capacity = size;
     vector->is_wrapping = true;
@@ -82,18 +320,91 @@ struct vector* vector_wrap_array(int size, vector_type* head) {
 }
 
 struct vector* vector_deep_copy_array(int size, const vector_type* head) {
-    struct vector* vector = malloc(sizeof(struct vector));
-    vector->size = size;
-    vector->capacity = size;
-    if (vector->capacity < INITIAL_CAPACITY) {
-        vector->capacity = INITIAL_CAPACITY;
+    struct vector* vector = vector_new();
+    vector_reserve(vector, size);
+    if (size > 0) {
+        memcpy(vector->head, head, sizeof(vector_type) * size);
     }
-    vector->is_wrapping = false;
-    vector->head = malloc(sizeof(vector_type) * vector->capacity);
-    memcpy(vector->head, head, sizeof(vector_type) * size);
+    vector->size = size;
     return vector;
 }
 
 struct vector* vector_clone(const struct vector* vector) {
-    return vector_deep_copy_array(vector->size, vector->head);
+    struct vector* clone = vector_new_with_allocator(vector->allocator);
+    vector_reserve(clone, vector->size);
+    if (vector->size > 0) {
+        memcpy(clone->head, vector->head, sizeof(vector_type) * vector->size);
+    }
+    clone->size = vector->size;
+    clone->growth_factor = vector->growth_factor;
+    clone->shrink_policy = vector->shrink_policy;
+    return clone;
+}
+
+void vector_make_unique(struct vector* vector) {
+    struct vector_shared* shared = vector->shared;
+    if (shared == NULL) {
+        return;
+    }
+
+    // Everyone else let go of it already, so it's ours
+    if (atomic_load(&shared->ref_count) == 1) {
+        allocator_free(vector->allocator, shared, sizeof(struct vector_shared));
+        vector->shared = NULL;
+        return;
+    }
+
+    vector_type* copy = allocator_malloc(vector->allocator, get_buffer_bytes(vector));
+    memcpy(copy, vector->head, sizeof(vector_type) * vector->size);
+
+    vector_release_shared(vector);
+    vector->head = copy;
+}
+
+struct vector* vector_clone_cow(struct vector* vector) {
+    // Small, wrapped and mapped buffers can't be handed to another owner, copy those straight away
+    if (vector->head == vector->inline_buffer || vector->is_wrapping || vector->mapping != NULL) {
+        return vector_clone(vector);
+    }
+
+    if (vector->shared == NULL) {
+        vector->shared = allocator_malloc(vector->allocator, sizeof(struct vector_shared));
+        atomic_init(&vector->shared->ref_count, 1);
+    }
+    atomic_fetch_add(&vector->shared->ref_count, 1);
+
+    struct vector* clone = vector_new_with_allocator(vector->allocator);
+    clone->size = vector->size;
+    clone->capacity = vector->capacity;
+    clone->growth_factor = vector->growth_factor;
+    clone->shrink_policy = vector->shrink_policy;
+    clone->head = vector->head;
+    clone->shared = vector->shared;
+    return clone;
+}
+
+struct vector_view vector_view_of(const struct vector* vector) {
+    return (struct vector_view) {vector->head, vector->size};
+}
+
+struct vector_view vector_view_slice(struct vector_view view, int begin, int end) {
+    if (begin < 0 || end > view.size || begin > end) {
+        return (struct vector_view) {NULL, 0};
+    }
+    return (struct vector_view) {view.head + begin, end - begin};
+}
+
+struct vector_view vector_slice(const struct vector* vector, int begin, int end) {
+    return vector_view_slice(vector_view_of(vector), begin, end);
+}
+
+const vector_type* vector_view_at(struct vector_view view, int index) {
+    if (index < 0 || index >= view.size) {
+        return NULL;
+    }
+    return &view.head[index];
+}
+
+struct vector* vector_from_view(struct vector_view view) {
+    return vector_deep_copy_array(view.size, view.head);
 }
\ No newline at end of file
@@ -1,13 +1,40 @@
 #pragma once
 #include <stdbool.h>
 
+struct allocator;
+
 typedef int vector_type;
 
+// Elements stored inside the struct itself before the first heap allocation
+#define VECTOR_INLINE_CAPACITY 8
+
+#define VECTOR_GROWTH_FACTOR_DEFAULT 2.0
+#define VECTOR_GROWTH_FACTOR_COMPACT 1.5 // for memory sensitive use
+
+enum vector_shrink_policy {
+    VECTOR_SHRINK_NEVER, // pop keeps the capacity, use vector_trim or vector_shrink_to_fit to release it
+    VECTOR_SHRINK_HYSTERESIS, // pop halves the capacity once size drops to a quarter of it
+};
+
+enum vector_mmap_mode {
+    VECTOR_MMAP_READ_ONLY, // existing file, modifying the vector exits with an error
+    VECTOR_MMAP_READ_WRITE, // existing file, or a new one if it doesn't exist
+    VECTOR_MMAP_TRUNCATE, // always starts empty, discarding what was in the file
+};
+
+// head points at inline_buffer while the vector is small, so a vector must not be
+// copied by value (the copy would still point at the original's buffer)
 struct vector {
     int size;
     int capacity;
     bool is_wrapping;
+    struct vector_mapping* mapping; // file backing head when opened with vector_open_mmap, otherwise NULL
+    struct vector_shared* shared; // set while head is shared with copy on write clones
+    double growth_factor;
+    enum vector_shrink_policy shrink_policy;
+    const struct allocator* allocator; // everything the vector allocates comes from here, libc unless set at construction
     vector_type* head; // array holds capacity * sizeof(vector_type)
+    vector_type inline_buffer[VECTOR_INLINE_CAPACITY];
 };
 
 struct vector_type_nullable {
@@ -15,14 +42,85 @@ struct vector_type_nullable {
     vector_type data;
 };
 
+// Non-owning pointer and length, meant to be passed around by value
+struct vector_view {
+    const vector_type* head;
+    int size;
+};
+
 struct vector* vector_new();
 void vector_free(struct vector* vector);
 
+// For vectors that live on the stack or inside another struct, no allocation until it outgrows the inline buffer
+void vector_init(struct vector* vector);
+// Buffers come from allocator (which has to outlive the vector), and so does the struct from vector_new_with_allocator
+struct vector* vector_new_with_allocator(const struct allocator* allocator);
+void vector_init_with_allocator(struct vector* vector, const struct allocator* allocator);
+void vector_destroy(struct vector* vector);
+
+void vector_set_growth_factor(struct vector* vector, double growth_factor);
+void vector_reserve(struct vector* vector, int capacity);
+void vector_shrink_to_fit(struct vector* vector);
+void vector_set_shrink_policy(struct vector* vector, enum vector_shrink_policy shrink_policy);
+// Releases capacity down to the hysteresis level (at least twice the size), keeping room for pushes
+void vector_trim(struct vector* vector);
+
 void vector_push(struct vector* vector, vector_type value);
 struct vector_type_nullable vector_pop(struct vector* vector);
 
 vector_type* vector_at(const struct vector* vector, int index);
 
+// Bulk operations, one capacity check and a single memcpy/memmove each
+void vector_append(struct vector* vector, const vector_type* src, int count);
+void vector_extend(struct vector* vector, const struct vector* other);
+bool vector_insert_range(struct vector* vector, int index, const vector_type* src, int count);
+bool vector_erase_range(struct vector* vector, int begin, int end); // erases [begin, end)
+void vector_resize(struct vector* vector, int size, vector_type fill);
+
+// Scans and element-wise math, vectorized with SSE4.2 or AVX2 when the CPU has it (x86-64 only, scalar elsewhere)
+enum vector_simd_level {
+    VECTOR_SIMD_SCALAR,
+    VECTOR_SIMD_SSE42,
+    VECTOR_SIMD_AVX2,
+};
+
+enum vector_simd_level vector_simd_get_level();
+// Caps the kernels used to level (mostly for benchmarks and tests), returns the level actually in use
+enum vector_simd_level vector_simd_set_level(enum vector_simd_level level);
+
+int vector_find(const struct vector* vector, vector_type value); // -1 if not found
+int vector_count(const struct vector* vector, vector_type value);
+long long vector_sum(const struct vector* vector);
+struct vector_type_nullable vector_min(const struct vector* vector);
+struct vector_type_nullable vector_max(const struct vector* vector);
+void vector_add_scalar(struct vector* vector, vector_type value);
+void vector_mul_scalar(struct vector* vector, vector_type value);
+bool vector_add(struct vector* a, const struct vector* b); // a[i] += b[i], false if the sizes differ
+
+// Radix sort, large vectors are split across threads (one per CPU) and merged
+void vector_sort(struct vector* vector);
+void vector_sort_parallel(struct vector* vector, int thread_count); // thread_count <= 0 uses one per CPU
+// On sorted vectors only
+int vector_lower_bound(const struct vector* vector, vector_type value); // first index not less than value
+int vector_binary_search(const struct vector* vector, vector_type value); // -1 if not found
+
+// File backed vector, pages to disk and grows the file as it's pushed to.
+// The size is only written to the file by vector_sync and vector_free.
+struct vector* vector_open_mmap(const char* path, enum vector_mmap_mode mode); // NULL if it can't be opened
+bool vector_sync(const struct vector* vector);
+
 struct vector* vector_wrap_array(int size, vector_type* head);
 struct vector* vector_deep_copy_array(int size, const vector_type* head);
-struct vector* vector_clone(const struct vector* vector);
\ No newline at end of file
+struct vector* vector_clone(const struct vector* vector);
+
+// Shares the buffer until either vector is modified, then the modified one copies it.
+// Writing through vector_at bypasses that, call vector_make_unique before doing so.
+struct vector* vector_clone_cow(struct vector* vector);
+void vector_make_unique(struct vector* vector);
+
+// Views are only valid until the vector is next modified
+struct vector_view vector_view_of(const struct vector* vector);
+struct vector_view vector_slice(const struct vector* vector, int begin, int end); // [begin, end), empty if out of range
+struct vector_view vector_view_slice(struct vector_view view, int begin, int end);
+const vector_type* vector_view_at(struct vector_view view, int index);
+struct vector* vector_from_view(struct vector_view view);
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "vector.h"
+#include "vector_template.h"
+#include "../bench/bench.h"
+#include "../bench/benchmarks.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Vector benchmarks, run through the shared harness (see bench.h) with `cstuff bench --filter <name>`.
+// Most measurements are compared against the same work done on a plain array where that makes sense.
+// The oscillation benchmark reports how often the capacity changed in the counter column.
+
+#define OSCILLATION_ROUNDS 200000
+
+VECTOR_DEFINE(bench_vector_int, int)
+
+static unsigned int random_state = 2463534242u;
+
+static unsigned int next_random() {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static vector_type* random_array(int size) {
+    vector_type* array = malloc(sizeof(vector_type) * size);
+    for (int i = 0; i < size; i++) {
+        array[i] = (vector_type) next_random();
+    }
+    return array;
+}
+
+static void bench_push(int size) {
+    BENCH_MEASURE("push", "growth_2.0", size, size,
+            struct vector* vec = vector_new(),
+            for (int i = 0; i < size; i++) vector_push(vec, i),
+            bench_sink += vec->size; vector_free(vec));
+
+    BENCH_MEASURE("push", "growth_1.5", size, size,
+            struct vector* vec = vector_new(); vector_set_growth_factor(vec, VECTOR_GROWTH_FACTOR_COMPACT),
+            for (int i = 0; i < size; i++) vector_push(vec, i),
+            bench_sink += vec->size; vector_free(vec));
+
+    BENCH_MEASURE("push", "reserved", size, size,
+            struct vector* vec = vector_new(); vector_reserve(vec, size),
+            for (int i = 0; i < size; i++) vector_push(vec, i),
+            bench_sink += vec->size; vector_free(vec));
+
+    BENCH_MEASURE("push", "template", size, size,
+            struct bench_vector_int vec; bench_vector_int_init(&vec),
+            for (int i = 0; i < size; i++) bench_vector_int_push(&vec, i),
+            bench_sink += vec.size; bench_vector_int_destroy(&vec));
+
+    BENCH_MEASURE("push", "plain_array", size, size,
+            vector_type* array = malloc(sizeof(vector_type) * size),
+            for (int i = 0; i < size; i++) array[i] = i,
+            bench_sink += array[size - 1]; free(array));
+}
+
+// Follows a random cycle through the elements, each read depends on the previous one
+static void bench_random_at(int size) {
+    vector_type* cycle = malloc(sizeof(vector_type) * size);
+    for (int i = 0; i < size; i++) {
+        cycle[i] = i;
+    }
+    // Sattolo's shuffle gives a single cycle through every index
+    for (int i = size - 1; i > 0; i--) {
+        const int j = (int) (next_random() % (unsigned int) i);
+        const vector_type temp = cycle[i];
+        cycle[i] = cycle[j];
+        cycle[j] = temp;
+    }
+
+    struct vector* vec = vector_deep_copy_array(size, cycle);
+    const int steps = size < 1000000 ? 1000000 : size;
+
+    BENCH_MEASURE("random_at", "vector_at", size, steps,
+            int index = 0,
+            for (int i = 0; i < steps; i++) index = *vector_at(vec, index),
+            bench_sink += index);
+
+    BENCH_MEASURE("random_at", "plain_array", size, steps,
+            int index = 0,
+            for (int i = 0; i < steps; i++) index = cycle[index],
+            bench_sink += index);
+
+    vector_free(vec);
+    free(cycle);
+}
+
+static void bench_bulk_append(int size) {
+    vector_type* source = random_array(size);
+
+    BENCH_MEASURE("bulk_append", "vector_append", size, size,
+            struct vector* vec = vector_new(),
+            vector_append(vec, source, size),
+            bench_sink += vec->size; vector_free(vec));
+
+    BENCH_MEASURE("bulk_append", "push_loop", size, size,
+            struct vector* vec = vector_new(),
+            for (int i = 0; i < size; i++) vector_push(vec, source[i]),
+            bench_sink += vec->size; vector_free(vec));
+
+    BENCH_MEASURE("bulk_append", "plain_array_memcpy", size, size,
+            vector_type* array = malloc(sizeof(vector_type) * size),
+            memcpy(array, source, sizeof(vector_type) * size),
+            bench_sink += array[size - 1]; free(array));
+
+    free(source);
+}
+
+static int compare_vector_type(const void* a, const void* b) {
+    const vector_type l = *(const vector_type*) a;
+    const vector_type r = *(const vector_type*) b;
+    return (l > r) - (l < r);
+}
+
+static void bench_sort(int size) {
+    vector_type* source = random_array(size);
+
+    BENCH_MEASURE("sort", "vector_sort", size, size,
+            struct vector* vec = vector_deep_copy_array(size, source),
+            vector_sort(vec),
+            bench_sink += vec->head[0]; vector_free(vec));
+
+    BENCH_MEASURE("sort", "vector_sort_parallel", size, size,
+            struct vector* vec = vector_deep_copy_array(size, source),
+            vector_sort_parallel(vec, 0),
+            bench_sink += vec->head[0]; vector_free(vec));
+
+    BENCH_MEASURE("sort", "qsort", size, size,
+            vector_type* array = malloc(sizeof(vector_type) * size); memcpy(array, source, sizeof(vector_type) * size),
+            qsort(array, size, sizeof(vector_type), compare_vector_type),
+            bench_sink += array[0]; free(array));
+
+    free(source);
+}
+
+static const char* simd_level_name(enum vector_simd_level level) {
+    switch (level) {
+        case VECTOR_SIMD_SCALAR:
+            return "scalar";
+        case VECTOR_SIMD_SSE42:
+            return "sse4.2";
+        case VECTOR_SIMD_AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+static void bench_simd(int size) {
+    vector_type* source = random_array(size);
+    struct vector* vec = vector_deep_copy_array(size, source);
+    const vector_type missing = 0x7fffffff; // Not found, so find scans everything
+    for (int i = 0; i < size; i++) {
+        if (vec->head[i] == missing) {
+            vec->head[i] = 0;
+        }
+    }
+
+    const enum vector_simd_level default_level = vector_simd_get_level();
+    const enum vector_simd_level levels[] = {VECTOR_SIMD_SCALAR, VECTOR_SIMD_SSE42, VECTOR_SIMD_AVX2};
+
+    for (int l = 0; l < 3; l++) {
+        if (vector_simd_set_level(levels[l]) != levels[l]) {
+            continue;
+        }
+        const char* name = simd_level_name(levels[l]);
+
+        BENCH_MEASURE("simd_find", name, size, size, , bench_sink += vector_find(vec, missing), );
+        BENCH_MEASURE("simd_count", name, size, size, , bench_sink += vector_count(vec, 12345), );
+        BENCH_MEASURE("simd_sum", name, size, size, , bench_sink += vector_sum(vec), );
+        BENCH_MEASURE("simd_min", name, size, size, , bench_sink += vector_min(vec).data, );
+        BENCH_MEASURE("simd_add_scalar", name, size, size, , vector_add_scalar(vec, 3), );
+    }
+    vector_simd_set_level(default_level);
+
+    // Plain loops over the array for comparison, the compiler is free to vectorize these itself
+    BENCH_MEASURE("simd_find", "plain_array", size, size, ,
+            int found = -1; for (int i = 0; i < size; i++) if (source[i] == missing) { found = i; break; } bench_sink += found, );
+    BENCH_MEASURE("simd_count", "plain_array", size, size, ,
+            int count = 0; for (int i = 0; i < size; i++) count += source[i] == 12345; bench_sink += count, );
+    BENCH_MEASURE("simd_sum", "plain_array", size, size, ,
+            long long sum = 0; for (int i = 0; i < size; i++) sum += source[i]; bench_sink += sum, );
+    BENCH_MEASURE("simd_min", "plain_array", size, size, ,
+            vector_type min = source[0]; for (int i = 1; i < size; i++) if (source[i] < min) min = source[i]; bench_sink += min, );
+    BENCH_MEASURE("simd_add_scalar", "plain_array", size, size, ,
+            for (int i = 0; i < size; i++) source[i] = (vector_type) ((unsigned int) source[i] + 3u), );
+
+    vector_free(vec);
+    free(source);
+}
+
+static const char* shrink_policy_name(enum vector_shrink_policy policy) {
+    switch (policy) {
+        case VECTOR_SHRINK_NEVER:
+            return "never";
+        case VECTOR_SHRINK_HYSTERESIS:
+            return "hysteresis";
+    }
+    return "unknown";
+}
+
+// Push/pop oscillation around the points where the vector grows or would shrink.
+// The time per operation should stay flat as the vector size grows, which is what amortized O(1) looks like.
+// Fills the vector up to size, then alternates bursts of burst pushes and burst pops
+static void bench_oscillation(enum vector_shrink_policy policy, double growth_factor, int size, int burst) {
+    struct vector* vec = vector_new();
+    vector_set_growth_factor(vec, growth_factor);
+    vector_set_shrink_policy(vec, policy);
+
+    for (int i = 0; i < size; i++) {
+        vector_push(vec, i);
+    }
+
+    long long capacity_changes = 0;
+    long long operations = 0;
+    int last_capacity = vec->capacity;
+
+    const double start = bench_now_ns();
+    for (int round = 0; round < OSCILLATION_ROUNDS / burst; round++) {
+        for (int i = 0; i < burst; i++) {
+            vector_push(vec, i);
+        }
+        if (vec->capacity != last_capacity) {
+            capacity_changes++;
+            last_capacity = vec->capacity;
+        }
+
+        for (int i = 0; i < burst; i++) {
+            vector_pop(vec);
+        }
+        if (vec->capacity != last_capacity) {
+            capacity_changes++;
+            last_capacity = vec->capacity;
+        }
+
+        operations += burst * 2;
+    }
+    double elapsed = bench_now_ns() - start;
+
+    char variant[64];
+    snprintf(variant, sizeof(variant), "%s_growth_%.1f_burst_%i", shrink_policy_name(policy), growth_factor, burst);
+    bench_report("oscillation", variant, size, operations, &elapsed, 1, capacity_changes);
+
+    vector_free(vec);
+}
+
+void run_vector_benchmarks() {
+    const int sizes[] = {1 << 10, 1 << 16, 1 << 20};
+
+    for (int s = 0; s < 3; s++) {
+        bench_push(sizes[s]);
+        bench_random_at(sizes[s]);
+        bench_bulk_append(sizes[s]);
+        bench_sort(sizes[s]);
+        bench_simd(sizes[s]);
+    }
+
+    if (!bench_is_selected("oscillation")) {
+        return;
+    }
+
+    const enum vector_shrink_policy policies[] = {VECTOR_SHRINK_NEVER, VECTOR_SHRINK_HYSTERESIS};
+    const double growth_factors[] = {VECTOR_GROWTH_FACTOR_DEFAULT, VECTOR_GROWTH_FACTOR_COMPACT};
+    const int bursts[] = {1, 64, 4096};
+
+    for (int p = 0; p < 2; p++) {
+        for (int g = 0; g < 2; g++) {
+            for (int s = 0; s < 3; s++) {
+                for (int b = 0; b < 3; b++) {
+                    bench_oscillation(policies[p], growth_factors[g], sizes[s], bursts[b]);
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "vector_deque.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 8 // must be a power of two
+
+struct vector_deque* vector_deque_new() {
+    struct vector_deque* deque = malloc(sizeof(struct vector_deque));
+    deque->size = 0;
+    deque->capacity = INITIAL_CAPACITY;
+    deque->front = 0;
+    deque->buffer = malloc(sizeof(vector_type) * INITIAL_CAPACITY);
+    return deque;
+}
+
+void vector_deque_free(struct vector_deque* deque) {
+    free(deque->buffer);
+    free(deque);
+}
+
+static int get_mask(const struct vector_deque* deque) {
+    return deque->capacity - 1;
+}
+
+// Copies count elements starting at the logical index into out, in at most two pieces
+static void copy_out(const struct vector_deque* deque, int index, int count, vector_type* out) {
+    const int start = (deque->front + index) & get_mask(deque);
+    const int first_piece = count < deque->capacity - start ? count : deque->capacity - start;
+
+    memcpy(out, deque->buffer + start, sizeof(vector_type) * first_piece);
+    memcpy(out + first_piece, deque->buffer, sizeof(vector_type) * (count - first_piece));
+}
+
+// Doubles the capacity, unwrapping the elements to the start of the new buffer
+static void grow(struct vector_deque* deque) {
+    const int new_capacity = deque->capacity * 2;
+    vector_type* new_buffer = malloc(sizeof(vector_type) * new_capacity);
+    if (new_buffer == NULL) {
+        printf("failed to malloc");
+        exit(1);
+    }
+
+    copy_out(deque, 0, deque->size, new_buffer);
+    free(deque->buffer);
+
+    deque->buffer = new_buffer;
+    deque->capacity = new_capacity;
+    deque->front = 0;
+}
+
+void vector_deque_push_back(struct vector_deque* deque, vector_type value) {
+    if (deque->size == deque->capacity) {
+        grow(deque);
+    }
+
+    deque->buffer[(deque->front + deque->size) & get_mask(deque)] = value;
+    deque->size++;
+}
+
+void vector_deque_push_front(struct vector_deque* deque, vector_type value) {
+    if (deque->size == deque->capacity) {
+        grow(deque);
+    }
+
+    deque->front = (deque->front - 1) & get_mask(deque);
+    deque->buffer[deque->front] = value;
+    deque->size++;
+}
+
+struct vector_type_nullable vector_deque_pop_back(struct vector_deque* deque) {
+    if (deque->size == 0) {
+        return (struct vector_type_nullable) {true};
+    }
+
+    deque->size--;
+    return (struct vector_type_nullable) {false, deque->buffer[(deque->front + deque->size) & get_mask(deque)]};
+}
+
+struct vector_type_nullable vector_deque_pop_front(struct vector_deque* deque) {
+    if (deque->size == 0) {
+        return (struct vector_type_nullable) {true};
+    }
+
+    const vector_type value = deque->buffer[deque->front];
+    deque->front = (deque->front + 1) & get_mask(deque);
+    deque->size--;
+    return (struct vector_type_nullable) {false, value};
+}
+
+vector_type* vector_deque_at(const struct vector_deque* deque, int index) {
+    if (index < 0 || index >= deque->size) {
+        return NULL;
+    }
+
+    return &deque->buffer[(deque->front + index) & get_mask(deque)];
+}
+
+int vector_deque_drain(struct vector_deque* deque, vector_type* out, int max_count) {
+    const int count = max_count < deque->size ? max_count : deque->size;
+    if (count <= 0) {
+        return 0;
+    }
+
+    copy_out(deque, 0, count, out);
+    deque->front = (deque->front + count) & get_mask(deque);
+    deque->size -= count;
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include "vector.h"
+
+// Ring buffer with O(1) push and pop at both ends. Capacity is always a power of two
+// so wrapping an index around is a mask instead of a modulo.
+
+struct vector_deque {
+    int size;
+    int capacity;
+    int front; // index in buffer of the first element
+    vector_type* buffer;
+};
+
+struct vector_deque* vector_deque_new();
+void vector_deque_free(struct vector_deque* deque);
+
+void vector_deque_push_back(struct vector_deque* deque, vector_type value);
+void vector_deque_push_front(struct vector_deque* deque, vector_type value);
+struct vector_type_nullable vector_deque_pop_back(struct vector_deque* deque);
+struct vector_type_nullable vector_deque_pop_front(struct vector_deque* deque);
+
+vector_type* vector_deque_at(const struct vector_deque* deque, int index); // index 0 is the front
+
+// Removes up to max_count elements from the front into out, returns how many were moved
+int vector_deque_drain(struct vector_deque* deque, vector_type* out, int max_count);
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include "vector.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Storage of vectors opened with vector_open_mmap, is_wrapping is set on them since
+// head isn't malloc'd, vector.c hands growing and freeing over to vector_mmap.c
+
+struct vector_mapping {
+    int fd;
+    bool is_read_only;
+    void* address; // file header, followed by the elements
+    size_t byte_size;
+};
+
+void vector_mmap_set_capacity(struct vector* vector, int new_capacity);
+void vector_mmap_close(struct vector* vector);
+
+// Buffer shared between copy on write clones, head is an ordinary malloc'd buffer owned
+// by whichever sharer releases it last
+struct vector_shared {
+    atomic_int ref_count;
+};
+
+// Every function that writes to head calls this first
+static inline void vector_prepare_write(struct vector* vector) {
+    if (vector->shared != NULL) {
+        vector_make_unique(vector);
+    }
+
+    // Read only mappings are PROT_READ, and their capacity goes to the end of the last page of the file,
+    // so even a push that fits would fault
+    if (vector->mapping != NULL && vector->mapping->is_read_only) {
+        printf("vector: cannot write to a read only mapped vector");
+        exit(1);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+// NOLINTNEXTLINE
+#define _GNU_SOURCE
+#include "vector_internal.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define VECTOR_MMAP_MAGIC 0x3152544345564343ULL // "CCVECTR1"
+#define VECTOR_MMAP_INITIAL_CAPACITY 1024
+
+// Padded so the elements after it stay cache line aligned
+struct vector_mmap_header {
+    uint64_t magic;
+    uint64_t element_size;
+    uint64_t size;
+    uint8_t padding[40];
+};
+
+static struct vector_mmap_header* get_header(const struct vector_mapping* mapping) {
+    return (struct vector_mmap_header*) mapping->address;
+}
+
+static vector_type* get_elements(const struct vector_mapping* mapping) {
+    return (vector_type*) ((char*) mapping->address + sizeof(struct vector_mmap_header));
+}
+
+static int get_capacity(size_t byte_size) {
+    return (int) ((byte_size - sizeof(struct vector_mmap_header)) / sizeof(vector_type));
+}
+
+// Files are always a whole number of pages, so the capacity rounds up to fill the last one
+static size_t get_byte_size_for_capacity(int capacity) {
+    const size_t page_size = getpagesize();
+    const size_t byte_size = sizeof(struct vector_mmap_header) + sizeof(vector_type) * (size_t) capacity;
+    return (byte_size + page_size - 1) / page_size * page_size;
+}
+
+struct vector* vector_open_mmap(const char* path, enum vector_mmap_mode mode) {
+    int flags = O_RDWR | O_CREAT;
+    if (mode == VECTOR_MMAP_READ_ONLY) {
+        flags = O_RDONLY;
+    } else if (mode == VECTOR_MMAP_TRUNCATE) {
+        flags |= O_TRUNC;
+    }
+
+    const int fd = open(path, flags, 0644);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t byte_size = file_stat.st_size;
+    const bool is_new = byte_size == 0;
+
+    if (is_new) {
+        if (mode == VECTOR_MMAP_READ_ONLY) {
+            close(fd);
+            return NULL;
+        }
+        byte_size = get_byte_size_for_capacity(VECTOR_MMAP_INITIAL_CAPACITY);
+        if (ftruncate(fd, (off_t) byte_size) == -1) {
+            close(fd);
+            return NULL;
+        }
+    } else if (byte_size < sizeof(struct vector_mmap_header)) {
+        close(fd);
+        return NULL;
+    }
+
+    const int protection = mode == VECTOR_MMAP_READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* address = mmap(NULL, byte_size, protection, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    struct vector_mapping* mapping = malloc(sizeof(struct vector_mapping));
+    mapping->fd = fd;
+    mapping->is_read_only = mode == VECTOR_MMAP_READ_ONLY;
+    mapping->address = address;
+    mapping->byte_size = byte_size;
+
+    struct vector_mmap_header* header = get_header(mapping);
+    if (is_new) {
+        header->magic = VECTOR_MMAP_MAGIC;
+        header->element_size = sizeof(vector_type);
+        header->size = 0;
+    } else if (header->magic != VECTOR_MMAP_MAGIC || header->element_size != sizeof(vector_type)
+               || header->size > (uint64_t) get_capacity(byte_size)) {
+        munmap(address, byte_size);
+        close(fd);
+        free(mapping);
+        return NULL;
+    }
+
+    struct vector* vector = vector_new();
+    vector->size = (int) header->size;
+    vector->capacity = get_capacity(byte_size);
+    vector->is_wrapping = true;
+    vector->mapping = mapping;
+    vector->head = get_elements(mapping);
+    return vector;
+}
+
+// Only ever grows, shrinking a mapped vector leaves the file as it is
+void vector_mmap_set_capacity(struct vector* vector, int new_capacity) {
+    struct vector_mapping* mapping = vector->mapping;
+    if (new_capacity <= vector->capacity) {
+        return;
+    }
+
+    if (mapping->is_read_only) {
+        printf("vector: cannot grow a read only mapped vector");
+        exit(1);
+    }
+
+    const size_t new_byte_size = get_byte_size_for_capacity(new_capacity);
+    if (ftruncate(mapping->fd, (off_t) new_byte_size) == -1) {
+        printf("vector: failed to grow mapped file");
+        exit(1);
+    }
+
+    void* address = mremap(mapping->address, mapping->byte_size, new_byte_size, MREMAP_MAYMOVE);
+    if (address == MAP_FAILED) {
+        printf("vector: failed to remap file");
+        exit(1);
+    }
+
+    mapping->address = address;
+    mapping->byte_size = new_byte_size;
+    vector->head = get_elements(mapping);
+    vector->capacity = get_capacity(new_byte_size);
+}
+
+bool vector_sync(const struct vector* vector) {
+    const struct vector_mapping* mapping = vector->mapping;
+    if (mapping == NULL) {
+        return false;
+    }
+    if (mapping->is_read_only) {
+        return true;
+    }
+
+    get_header(mapping)->size = (uint64_t) vector->size;
+    return msync(mapping->address, mapping->byte_size, MS_SYNC) == 0;
+}
+
+void vector_mmap_close(struct vector* vector) {
+    struct vector_mapping* mapping = vector->mapping;
+
+    if (!mapping->is_read_only) {
+        get_header(mapping)->size = (uint64_t) vector->size;
+    }
+
+    munmap(mapping->address, mapping->byte_size);
+    close(mapping->fd);
+    free(mapping);
+    vector->mapping = NULL;
+}
\ No newline at end of file
@@ -0,0 +1,465 @@
+#include "vector.h"
+#include "vector_internal.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+// x86-64 only, the sum kernels need 64 bit lane extracts (_mm_extract_epi64, _mm_cvtsi128_si64) that 32 bit x86 lacks
+#if defined(__x86_64__)
+#define VECTOR_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Each operation has a scalar, SSE4.2 and AVX2 kernel, picked once at runtime from what the CPU supports.
+// Adds and multiplies wrap on overflow in every kernel (the scalar ones go through unsigned to match the SIMD ones).
+
+struct vector_simd_kernels {
+    enum vector_simd_level level;
+    int (*find)(const vector_type* data, int size, vector_type value);
+    int (*count)(const vector_type* data, int size, vector_type value);
+    long long (*sum)(const vector_type* data, int size);
+    vector_type (*min)(const vector_type* data, int size); // size > 0
+    vector_type (*max)(const vector_type* data, int size); // size > 0
+    void (*add_scalar)(vector_type* data, int size, vector_type value);
+    void (*mul_scalar)(vector_type* data, int size, vector_type value);
+    void (*add)(vector_type* a, const vector_type* b, int size);
+};
+
+static int find_scalar(const vector_type* data, int size, vector_type value) {
+    for (int i = 0; i < size; i++) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int count_scalar(const vector_type* data, int size, vector_type value) {
+    int count = 0;
+    for (int i = 0; i < size; i++) {
+        count += data[i] == value;
+    }
+    return count;
+}
+
+static long long sum_scalar(const vector_type* data, int size) {
+    long long sum = 0;
+    for (int i = 0; i < size; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static vector_type min_scalar(const vector_type* data, int size) {
+    vector_type min = data[0];
+    for (int i = 1; i < size; i++) {
+        if (data[i] < min) {
+            min = data[i];
+        }
+    }
+    return min;
+}
+
+static vector_type max_scalar(const vector_type* data, int size) {
+    vector_type max = data[0];
+    for (int i = 1; i < size; i++) {
+        if (data[i] > max) {
+            max = data[i];
+        }
+    }
+    return max;
+}
+
+static void add_scalar_scalar(vector_type* data, int size, vector_type value) {
+    for (int i = 0; i < size; i++) {
+        data[i] = (vector_type) ((unsigned int) data[i] + (unsigned int) value);
+    }
+}
+
+static void mul_scalar_scalar(vector_type* data, int size, vector_type value) {
+    for (int i = 0; i < size; i++) {
+        data[i] = (vector_type) ((unsigned int) data[i] * (unsigned int) value);
+    }
+}
+
+static void add_scalar(vector_type* a, const vector_type* b, int size) {
+    for (int i = 0; i < size; i++) {
+        a[i] = (vector_type) ((unsigned int) a[i] + (unsigned int) b[i]);
+    }
+}
+
+static const struct vector_simd_kernels scalar_kernels = {
+    VECTOR_SIMD_SCALAR,
+    find_scalar,
+    count_scalar,
+    sum_scalar,
+    min_scalar,
+    max_scalar,
+    add_scalar_scalar,
+    mul_scalar_scalar,
+    add_scalar,
+};
+
+#ifdef VECTOR_SIMD_X86
+
+// SSE4.2 kernels, 4 ints per register
+
+__attribute__((target("sse4.2")))
+static int find_sse42(const vector_type* data, int size, vector_type value) {
+    const __m128i needle = _mm_set1_epi32(value);
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) (data + i)), needle);
+        const int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    const int rest = find_scalar(data + i, size - i, value);
+    return rest == -1 ? -1 : i + rest;
+}
+
+__attribute__((target("sse4.2")))
+static int count_sse42(const vector_type* data, int size, vector_type value) {
+    const __m128i needle = _mm_set1_epi32(value);
+    __m128i counts = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        // Equal lanes are -1, so subtracting counts them
+        counts = _mm_sub_epi32(counts, _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) (data + i)), needle));
+    }
+    counts = _mm_add_epi32(counts, _mm_shuffle_epi32(counts, _MM_SHUFFLE(1, 0, 3, 2)));
+    counts = _mm_add_epi32(counts, _mm_shuffle_epi32(counts, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(counts) + count_scalar(data + i, size - i, value);
+}
+
+__attribute__((target("sse4.2")))
+static long long sum_sse42(const vector_type* data, int size) {
+    __m128i sums = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128i values = _mm_loadu_si128((const __m128i*) (data + i));
+        sums = _mm_add_epi64(sums, _mm_cvtepi32_epi64(values));
+        sums = _mm_add_epi64(sums, _mm_cvtepi32_epi64(_mm_srli_si128(values, 8)));
+    }
+    const long long sum = _mm_cvtsi128_si64(sums) + _mm_extract_epi64(sums, 1);
+    return sum + sum_scalar(data + i, size - i);
+}
+
+__attribute__((target("sse4.2")))
+static vector_type min_sse42(const vector_type* data, int size) {
+    if (size < 4) {
+        return min_scalar(data, size);
+    }
+    __m128i mins = _mm_loadu_si128((const __m128i*) data);
+    int i = 4;
+    for (; i + 4 <= size; i += 4) {
+        mins = _mm_min_epi32(mins, _mm_loadu_si128((const __m128i*) (data + i)));
+    }
+    mins = _mm_min_epi32(mins, _mm_shuffle_epi32(mins, _MM_SHUFFLE(1, 0, 3, 2)));
+    mins = _mm_min_epi32(mins, _mm_shuffle_epi32(mins, _MM_SHUFFLE(2, 3, 0, 1)));
+    const vector_type min = _mm_cvtsi128_si32(mins);
+    if (i == size) {
+        return min;
+    }
+    const vector_type rest = min_scalar(data + i, size - i);
+    return rest < min ? rest : min;
+}
+
+__attribute__((target("sse4.2")))
+static vector_type max_sse42(const vector_type* data, int size) {
+    if (size < 4) {
+        return max_scalar(data, size);
+    }
+    __m128i maxs = _mm_loadu_si128((const __m128i*) data);
+    int i = 4;
+    for (; i + 4 <= size; i += 4) {
+        maxs = _mm_max_epi32(maxs, _mm_loadu_si128((const __m128i*) (data + i)));
+    }
+    maxs = _mm_max_epi32(maxs, _mm_shuffle_epi32(maxs, _MM_SHUFFLE(1, 0, 3, 2)));
+    maxs = _mm_max_epi32(maxs, _mm_shuffle_epi32(maxs, _MM_SHUFFLE(2, 3, 0, 1)));
+    const vector_type max = _mm_cvtsi128_si32(maxs);
+    if (i == size) {
+        return max;
+    }
+    const vector_type rest = max_scalar(data + i, size - i);
+    return rest > max ? rest : max;
+}
+
+__attribute__((target("sse4.2")))
+static void add_scalar_sse42(vector_type* data, int size, vector_type value) {
+    const __m128i addend = _mm_set1_epi32(value);
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i* p = (__m128i*) (data + i);
+        _mm_storeu_si128(p, _mm_add_epi32(_mm_loadu_si128(p), addend));
+    }
+    add_scalar_scalar(data + i, size - i, value);
+}
+
+__attribute__((target("sse4.2")))
+static void mul_scalar_sse42(vector_type* data, int size, vector_type value) {
+    const __m128i factor = _mm_set1_epi32(value);
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i* p = (__m128i*) (data + i);
+        _mm_storeu_si128(p, _mm_mullo_epi32(_mm_loadu_si128(p), factor));
+    }
+    mul_scalar_scalar(data + i, size - i, value);
+}
+
+__attribute__((target("sse4.2")))
+static void add_sse42(vector_type* a, const vector_type* b, int size) {
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        __m128i* p = (__m128i*) (a + i);
+        _mm_storeu_si128(p, _mm_add_epi32(_mm_loadu_si128(p), _mm_loadu_si128((const __m128i*) (b + i))));
+    }
+    add_scalar(a + i, b + i, size - i);
+}
+
+static const struct vector_simd_kernels sse42_kernels = {
+    VECTOR_SIMD_SSE42,
+    find_sse42,
+    count_sse42,
+    sum_sse42,
+    min_sse42,
+    max_sse42,
+    add_scalar_sse42,
+    mul_scalar_sse42,
+    add_sse42,
+};
+
+// AVX2 kernels, 8 ints per register
+
+__attribute__((target("avx2")))
+static int find_avx2(const vector_type* data, int size, vector_type value) {
+    const __m256i needle = _mm256_set1_epi32(value);
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (data + i)), needle);
+        const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    const int rest = find_scalar(data + i, size - i, value);
+    return rest == -1 ? -1 : i + rest;
+}
+
+__attribute__((target("avx2")))
+static int count_avx2(const vector_type* data, int size, vector_type value) {
+    const __m256i needle = _mm256_set1_epi32(value);
+    __m256i counts = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        counts = _mm256_sub_epi32(counts, _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (data + i)), needle));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half) + count_scalar(data + i, size - i, value);
+}
+
+__attribute__((target("avx2")))
+static long long sum_avx2(const vector_type* data, int size) {
+    __m256i sums = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256i values = _mm256_loadu_si256((const __m256i*) (data + i));
+        sums = _mm256_add_epi64(sums, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+        sums = _mm256_add_epi64(sums, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+    }
+    const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    const long long sum = _mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1);
+    return sum + sum_scalar(data + i, size - i);
+}
+
+__attribute__((target("avx2")))
+static vector_type min_avx2(const vector_type* data, int size) {
+    if (size < 8) {
+        return min_scalar(data, size);
+    }
+    __m256i mins = _mm256_loadu_si256((const __m256i*) data);
+    int i = 8;
+    for (; i + 8 <= size; i += 8) {
+        mins = _mm256_min_epi32(mins, _mm256_loadu_si256((const __m256i*) (data + i)));
+    }
+    __m128i half = _mm_min_epi32(_mm256_castsi256_si128(mins), _mm256_extracti128_si256(mins, 1));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    const vector_type min = _mm_cvtsi128_si32(half);
+    if (i == size) {
+        return min;
+    }
+    const vector_type rest = min_scalar(data + i, size - i);
+    return rest < min ? rest : min;
+}
+
+__attribute__((target("avx2")))
+static vector_type max_avx2(const vector_type* data, int size) {
+    if (size < 8) {
+        return max_scalar(data, size);
+    }
+    __m256i maxs = _mm256_loadu_si256((const __m256i*) data);
+    int i = 8;
+    for (; i + 8 <= size; i += 8) {
+        maxs = _mm256_max_epi32(maxs, _mm256_loadu_si256((const __m256i*) (data + i)));
+    }
+    __m128i half = _mm_max_epi32(_mm256_castsi256_si128(maxs), _mm256_extracti128_si256(maxs, 1));
+    half = _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    const vector_type max = _mm_cvtsi128_si32(half);
+    if (i == size) {
+        return max;
+    }
+    const vector_type rest = max_scalar(data + i, size - i);
+    return rest > max ? rest : max;
+}
+
+__attribute__((target("avx2")))
+static void add_scalar_avx2(vector_type* data, int size, vector_type value) {
+    const __m256i addend = _mm256_set1_epi32(value);
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i* p = (__m256i*) (data + i);
+        _mm256_storeu_si256(p, _mm256_add_epi32(_mm256_loadu_si256(p), addend));
+    }
+    add_scalar_scalar(data + i, size - i, value);
+}
+
+__attribute__((target("avx2")))
+static void mul_scalar_avx2(vector_type* data, int size, vector_type value) {
+    const __m256i factor = _mm256_set1_epi32(value);
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i* p = (__m256i*) (data + i);
+        _mm256_storeu_si256(p, _mm256_mullo_epi32(_mm256_loadu_si256(p), factor));
+    }
+    mul_scalar_scalar(data + i, size - i, value);
+}
+
+__attribute__((target("avx2")))
+static void add_avx2(vector_type* a, const vector_type* b, int size) {
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        __m256i* p = (__m256i*) (a + i);
+        _mm256_storeu_si256(p, _mm256_add_epi32(_mm256_loadu_si256(p), _mm256_loadu_si256((const __m256i*) (b + i))));
+    }
+    add_scalar(a + i, b + i, size - i);
+}
+
+static const struct vector_simd_kernels avx2_kernels = {
+    VECTOR_SIMD_AVX2,
+    find_avx2,
+    count_avx2,
+    sum_avx2,
+    min_avx2,
+    max_avx2,
+    add_scalar_avx2,
+    mul_scalar_avx2,
+    add_avx2,
+};
+
+#endif
+
+static enum vector_simd_level get_supported_level() {
+#ifdef VECTOR_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return VECTOR_SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return VECTOR_SIMD_SSE42;
+    }
+#endif
+    return VECTOR_SIMD_SCALAR;
+}
+
+static const struct vector_simd_kernels* get_kernels_for_level(enum vector_simd_level level) {
+    switch (level) {
+#ifdef VECTOR_SIMD_X86
+        case VECTOR_SIMD_AVX2:
+            return &avx2_kernels;
+        case VECTOR_SIMD_SSE42:
+            return &sse42_kernels;
+#endif
+        default:
+            return &scalar_kernels;
+    }
+}
+
+// Picked on first use, any thread can get there first or call vector_simd_set_level at the same time
+static _Atomic(const struct vector_simd_kernels*) active_kernels = NULL;
+
+static const struct vector_simd_kernels* get_kernels() {
+    const struct vector_simd_kernels* kernels = atomic_load_explicit(&active_kernels, memory_order_acquire);
+    if (kernels == NULL) {
+        kernels = get_kernels_for_level(get_supported_level());
+        // Loses to a vector_simd_set_level that happened in the meantime, kernels is then what it set
+        const struct vector_simd_kernels* expected = NULL;
+        if (!atomic_compare_exchange_strong_explicit(&active_kernels, &expected, kernels,
+                                                     memory_order_acq_rel, memory_order_acquire)) {
+            kernels = expected;
+        }
+    }
+    return kernels;
+}
+
+enum vector_simd_level vector_simd_get_level() {
+    return get_kernels()->level;
+}
+
+enum vector_simd_level vector_simd_set_level(enum vector_simd_level level) {
+    const enum vector_simd_level supported = get_supported_level();
+    if (level > supported) {
+        level = supported;
+    }
+    atomic_store_explicit(&active_kernels, get_kernels_for_level(level), memory_order_release);
+    return level;
+}
+
+int vector_find(const struct vector* vector, vector_type value) {
+    return get_kernels()->find(vector->head, vector->size, value);
+}
+
+int vector_count(const struct vector* vector, vector_type value) {
+    return get_kernels()->count(vector->head, vector->size, value);
+}
+
+long long vector_sum(const struct vector* vector) {
+    return get_kernels()->sum(vector->head, vector->size);
+}
+
+struct vector_type_nullable vector_min(const struct vector* vector) {
+    if (vector->size == 0) {
+        return (struct vector_type_nullable) {true};
+    }
+    return (struct vector_type_nullable) {false, get_kernels()->min(vector->head, vector->size)};
+}
+
+struct vector_type_nullable vector_max(const struct vector* vector) {
+    if (vector->size == 0) {
+        return (struct vector_type_nullable) {true};
+    }
+    return (struct vector_type_nullable) {false, get_kernels()->max(vector->head, vector->size)};
+}
+
+void vector_add_scalar(struct vector* vector, vector_type value) {
+    vector_prepare_write(vector);
+    get_kernels()->add_scalar(vector->head, vector->size, value);
+}
+
+void vector_mul_scalar(struct vector* vector, vector_type value) {
+    vector_prepare_write(vector);
+    get_kernels()->mul_scalar(vector->head, vector->size, value);
+}
+
+bool vector_add(struct vector* a, const struct vector* b) {
+    if (a->size != b->size) {
+        return false;
+    }
+    vector_prepare_write(a);
+    get_kernels()->add(a->head, b->head, a->size);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "vector.h"
+#include "vector_internal.h"
+#include "../allocation/allocator.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define INSERTION_SORT_THRESHOLD 64
+#define PARALLEL_SORT_THRESHOLD (1 << 20)
+#define MAX_SORT_THREADS 64
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES ((int) (sizeof(vector_type) * 8 / RADIX_BITS))
+
+// Flipping the sign bit makes signed ints sort correctly as unsigned keys
+static unsigned int radix_key(vector_type value) {
+    return (unsigned int) value ^ 0x80000000u;
+}
+
+static void insertion_sort(vector_type* data, int size) {
+    for (int i = 1; i < size; i++) {
+        const vector_type value = data[i];
+        int j = i - 1;
+        while (j >= 0 && data[j] > value) {
+            data[j + 1] = data[j];
+            j--;
+        }
+        data[j + 1] = value;
+    }
+}
+
+// LSD radix sort of data using scratch (same size), the result always ends up back in data
+static void radix_sort(vector_type* data, vector_type* scratch, int size) {
+    if (size < INSERTION_SORT_THRESHOLD) {
+        insertion_sort(data, size);
+        return;
+    }
+
+    // All histograms in one read of the data
+    static_assert(RADIX_PASSES == 4, "radix sort expects 32 bit vector_type");
+    int counts[RADIX_PASSES][RADIX_BUCKETS];
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < size; i++) {
+        const unsigned int key = radix_key(data[i]);
+        for (int pass = 0; pass < RADIX_PASSES; pass++) {
+            counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    vector_type* from = data;
+    vector_type* to = scratch;
+
+    for (int pass = 0; pass < RADIX_PASSES; pass++) {
+        const int shift = pass * RADIX_BITS;
+        int* count = counts[pass];
+
+        // Every element has the same digit, the pass wouldn't move anything
+        if (count[(radix_key(from[0]) >> shift) & (RADIX_BUCKETS - 1)] == size) {
+            continue;
+        }
+
+        int offset = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            const int bucket_size = count[bucket];
+            count[bucket] = offset;
+            offset += bucket_size;
+        }
+
+        for (int i = 0; i < size; i++) {
+            const vector_type value = from[i];
+            to[count[(radix_key(value) >> shift) & (RADIX_BUCKETS - 1)]++] = value;
+        }
+
+        vector_type* temp = from;
+        from = to;
+        to = temp;
+    }
+
+    if (from != data) {
+        memcpy(data, from, sizeof(vector_type) * size);
+    }
+}
+
+static void merge(const vector_type* left, int left_size, const vector_type* right, int right_size, vector_type* out) {
+    int l = 0;
+    int r = 0;
+    int o = 0;
+
+    while (l < left_size && r < right_size) {
+        // <= keeps it stable
+        if (left[l] <= right[r]) {
+            out[o++] = left[l++];
+        } else {
+            out[o++] = right[r++];
+        }
+    }
+
+    memcpy(out + o, left + l, sizeof(vector_type) * (left_size - l));
+    o += left_size - l;
+    memcpy(out + o, right + r, sizeof(vector_type) * (right_size - r));
+}
+
+struct sort_task {
+    vector_type* data;
+    vector_type* scratch;
+    int begin;
+    int middle; // only used by merge tasks
+    int end;
+};
+
+static void* radix_sort_task(void* arg) {
+    const struct sort_task* task = arg;
+    radix_sort(task->data + task->begin, task->scratch + task->begin, task->end - task->begin);
+    return NULL;
+}
+
+// Merges [begin, middle) and [middle, end) of data into the same range of scratch
+static void* merge_task(void* arg) {
+    const struct sort_task* task = arg;
+    merge(task->data + task->begin, task->middle - task->begin,
+          task->data + task->middle, task->end - task->middle,
+          task->scratch + task->begin);
+    return NULL;
+}
+
+// Runs every task on its own thread, the calling thread takes the first one
+static void run_tasks(void* (*function)(void*), struct sort_task* tasks, int task_count) {
+    pthread_t threads[MAX_SORT_THREADS];
+    bool started[MAX_SORT_THREADS];
+
+    for (int i = 1; i < task_count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, function, &tasks[i]) == 0;
+        if (!started[i]) {
+            function(&tasks[i]);
+        }
+    }
+
+    function(&tasks[0]);
+
+    for (int i = 1; i < task_count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+static int get_default_thread_count() {
+    const long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu_count < 1) {
+        return 1;
+    }
+    return cpu_count > MAX_SORT_THREADS ? MAX_SORT_THREADS : (int) cpu_count;
+}
+
+void vector_sort_parallel(struct vector* vector, int thread_count) {
+    const int size = vector->size;
+    if (size < 2) {
+        return;
+    }
+    vector_prepare_write(vector);
+
+    if (thread_count <= 0) {
+        thread_count = get_default_thread_count();
+    }
+    if (thread_count > MAX_SORT_THREADS) {
+        thread_count = MAX_SORT_THREADS;
+    }
+    if (thread_count > size / INSERTION_SORT_THRESHOLD) {
+        thread_count = size / INSERTION_SORT_THRESHOLD > 0 ? size / INSERTION_SORT_THRESHOLD : 1;
+    }
+
+    vector_type* scratch = allocator_malloc(vector->allocator, sizeof(vector_type) * size);
+
+    // Each thread radix sorts one chunk into a sorted run
+    int run_bounds[MAX_SORT_THREADS + 1];
+    struct sort_task tasks[MAX_SORT_THREADS];
+    for (int i = 0; i <= thread_count; i++) {
+        run_bounds[i] = (int) ((long long) size * i / thread_count);
+    }
+    for (int i = 0; i < thread_count; i++) {
+        tasks[i] = (struct sort_task) {vector->head, scratch, run_bounds[i], 0, run_bounds[i + 1]};
+    }
+    run_tasks(radix_sort_task, tasks, thread_count);
+
+    // Then adjacent runs get merged pairwise in parallel, bouncing between the two buffers
+    vector_type* from = vector->head;
+    vector_type* to = scratch;
+    int run_count = thread_count;
+
+    while (run_count > 1) {
+        int task_count = 0;
+        int next_run_count = 0;
+
+        for (int i = 0; i < run_count; i += 2) {
+            if (i + 1 < run_count) {
+                tasks[task_count++] = (struct sort_task) {from, to, run_bounds[i], run_bounds[i + 1], run_bounds[i + 2]};
+            } else {
+                // Odd run out, merging with nothing just copies it across
+                tasks[task_count++] = (struct sort_task) {from, to, run_bounds[i], run_bounds[i + 1], run_bounds[i + 1]};
+            }
+            run_bounds[next_run_count++] = run_bounds[i];
+        }
+        run_bounds[next_run_count] = size;
+
+        run_tasks(merge_task, tasks, task_count);
+
+        run_count = next_run_count;
+        vector_type* temp = from;
+        from = to;
+        to = temp;
+    }
+
+    if (from != vector->head) {
+        memcpy(vector->head, from, sizeof(vector_type) * size);
+    }
+    allocator_free(vector->allocator, scratch, sizeof(vector_type) * size);
+}
+
+void vector_sort(struct vector* vector) {
+    const int size = vector->size;
+    vector_prepare_write(vector);
+
+    if (size < INSERTION_SORT_THRESHOLD) {
+        insertion_sort(vector->head, size);
+        return;
+    }
+
+    if (size >= PARALLEL_SORT_THRESHOLD && get_default_thread_count() > 1) {
+        vector_sort_parallel(vector, 0);
+        return;
+    }
+
+    vector_type* scratch = allocator_malloc(vector->allocator, sizeof(vector_type) * size);
+    radix_sort(vector->head, scratch, size);
+    allocator_free(vector->allocator, scratch, sizeof(vector_type) * size);
+}
+
+int vector_lower_bound(const struct vector* vector, vector_type value) {
+    int low = 0;
+    int high = vector->size;
+
+    while (low < high) {
+        const int middle = low + (high - low) / 2;
+        if (vector->head[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+int vector_binary_search(const struct vector* vector, vector_type value) {
+    const int index = vector_lower_bound(vector, value);
+    if (index < vector->size && vector->head[index] == value) {
+        return index;
+    }
+    return -1;
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#pragma once
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Type specialized vectors, VECTOR_DEFINE(vector_double, double) generates
+//
+//   struct vector_double { int size; int capacity; double* head; };
+//   vector_double_init / vector_double_destroy
+//   vector_double_reserve / vector_double_push / vector_double_pop / vector_double_at
+//   vector_double_append / vector_double_truncate / vector_double_clone_into
+//
+// All of them are static inline, so the element size is a compile time constant and
+// push/at compile down to a store/load. Elements are moved around with memcpy, which is
+// right for anything trivially copyable (numbers, pointers, plain structs).
+// Use VECTOR_DEFINE_WITH_COPY when elements own resources that have to be duplicated on
+// append/clone, copy(T* destination, const T* source) is then called once per element.
+// release(T* element) frees what an element owns, it's called for every element destroy,
+// clone_into or pop (without out) drops. push and pop into out move the element, so the
+// vector takes over or hands back what it owns.
+
+#define VECTOR_TEMPLATE_INITIAL_CAPACITY 8
+
+#define VECTOR_DEFINE(name, T) VECTOR_DEFINE_IMPL(name, T, 0, (void), (void))
+
+#define VECTOR_DEFINE_WITH_COPY(name, T, copy, release) VECTOR_DEFINE_IMPL(name, T, 1, copy, release)
+
+#define VECTOR_DEFINE_IMPL(name, T, has_copy, copy, release)                                            \
+    struct name {                                                                                       \
+        int size;                                                                                       \
+        int capacity;                                                                                   \
+        T* head;                                                                                        \
+    };                                                                                                  \
+                                                                                                        \
+    static inline void name##_init(struct name* vector) {                                               \
+        vector->size = 0;                                                                               \
+        vector->capacity = 0;                                                                           \
+        vector->head = NULL;                                                                            \
+    }                                                                                                   \
+                                                                                                        \
+    /* Releases the elements from index begin to the end, leaving begin elements */                     \
+    static inline void name##_truncate(struct name* vector, int begin) {                                \
+        if (begin < 0) {                                                                                \
+            begin = 0;                                                                                  \
+        }                                                                                               \
+        if (has_copy) {                                                                                 \
+            for (int i = begin; i < vector->size; i++) {                                                \
+                VECTOR_TEMPLATE_RELEASE_##has_copy(release, &vector->head[i]);                          \
+            }                                                                                           \
+        }                                                                                               \
+        if (begin < vector->size) {                                                                     \
+            vector->size = begin;                                                                       \
+        }                                                                                               \
+    }                                                                                                   \
+                                                                                                        \
+    static inline void name##_destroy(struct name* vector) {                                            \
+        name##_truncate(vector, 0);                                                                     \
+        free(vector->head);                                                                             \
+        name##_init(vector);                                                                            \
+    }                                                                                                   \
+                                                                                                        \
+    static inline void name##_reserve(struct name* vector, int capacity) {                              \
+        if (capacity <= vector->capacity) {                                                             \
+            return;                                                                                     \
+        }                                                                                               \
+        T* new_ptr = (T*) realloc(vector->head, sizeof(T) * (size_t) capacity);                         \
+        if (new_ptr == NULL) {                                                                          \
+            printf("failed to realloc");                                                                \
+            exit(1);                                                                                    \
+        }                                                                                               \
+        vector->head = new_ptr;                                                                         \
+        vector->capacity = capacity;                                                                    \
+    }                                                                                                   \
+                                                                                                        \
+    /* Kept out of line of push so the common path stays small enough to inline.                        \
+       Doubles in long long and clamps to INT_MAX, sizes are ints so anything past that exits */        \
+    static void name##_grow(struct name* vector, long long min_capacity) {                              \
+        if (min_capacity > INT_MAX) {                                                                   \
+            printf("vector: capacity overflow");                                                        \
+            exit(1);                                                                                    \
+        }                                                                                               \
+        long long capacity = vector->capacity > 0 ? 2LL * vector->capacity                              \
+                                                  : VECTOR_TEMPLATE_INITIAL_CAPACITY;                   \
+        while (capacity < min_capacity) {                                                               \
+            capacity *= 2;                                                                              \
+        }                                                                                               \
+        name##_reserve(vector, capacity > INT_MAX ? INT_MAX : (int) capacity);                          \
+    }                                                                                                   \
+                                                                                                        \
+    static inline void name##_push(struct name* vector, T value) {                                      \
+        if (__builtin_expect(vector->size >= vector->capacity, 0)) {                                    \
+            name##_grow(vector, (long long) vector->size + 1);                                          \
+        }                                                                                               \
+        vector->head[vector->size++] = value;                                                           \
+    }                                                                                                   \
+                                                                                                        \
+    /* Returns false when empty, otherwise the last element is moved into out (if not NULL) */          \
+    static inline bool name##_pop(struct name* vector, T* out) {                                        \
+        if (vector->size == 0) {                                                                        \
+            return false;                                                                               \
+        }                                                                                               \
+        if (out != NULL) {                                                                              \
+            *out = vector->head[--vector->size];                                                        \
+        } else {                                                                                        \
+            name##_truncate(vector, vector->size - 1);                                                  \
+        }                                                                                               \
+        return true;                                                                                    \
+    }                                                                                                   \
+                                                                                                        \
+    static inline T* name##_at(const struct name* vector, int index) {                                  \
+        if (index < 0 || index >= vector->size) {                                                       \
+            return NULL;                                                                                \
+        }                                                                                               \
+        return &vector->head[index];                                                                    \
+    }                                                                                                   \
+                                                                                                        \
+    /* src may point into the vector itself, growing moves the buffer so it's tracked by offset */      \
+    static inline void name##_append(struct name* vector, T const* src, int count) {                    \
+        if (count <= 0) {                                                                               \
+            return;                                                                                     \
+        }                                                                                               \
+        if (count > vector->capacity - vector->size) {                                                  \
+            const bool is_self = src >= vector->head && src < vector->head + vector->size;              \
+            const ptrdiff_t offset = is_self ? src - vector->head : 0;                                  \
+            name##_grow(vector, (long long) vector->size + count);                                      \
+            if (is_self) {                                                                              \
+                src = vector->head + offset;                                                            \
+            }                                                                                           \
+        }                                                                                               \
+        if (has_copy) {                                                                                 \
+            for (int i = 0; i < count; i++) {                                                           \
+                VECTOR_TEMPLATE_COPY_##has_copy(copy, &vector->head[vector->size + i], &src[i]);        \
+            }                                                                                           \
+        } else {                                                                                        \
+            memcpy(vector->head + vector->size, src, sizeof(T) * (size_t) count);                       \
+        }                                                                                               \
+        vector->size += count;                                                                          \
+    }                                                                                                   \
+                                                                                                        \
+    /* destination must be initialized (and is overwritten, releasing what it held) */                  \
+    static inline void name##_clone_into(struct name* destination, const struct name* source) {         \
+        if (destination == source) {                                                                    \
+            return;                                                                                     \
+        }                                                                                               \
+        name##_truncate(destination, 0);                                                                \
+        name##_append(destination, source->head, source->size);                                         \
+    }
+
+// Only expands the copy and release calls for VECTOR_DEFINE_WITH_COPY, so VECTOR_DEFINE doesn't need those functions
+#define VECTOR_TEMPLATE_COPY_0(copy, destination, source) ((void) 0)
+#define VECTOR_TEMPLATE_COPY_1(copy, destination, source) copy(destination, source)
+#define VECTOR_TEMPLATE_RELEASE_0(release, element) ((void) 0)
+#define VECTOR_TEMPLATE_RELEASE_1(release, element) release(element)
\ No newline at end of file
@@ -1,8 +1,15 @@
 #pragma once
 #include "vector.h"
+#include "vector_template.h"
+#include "concurrent_vector.h"
+#include "vector_deque.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 void testVectorBasic() {
     printf("=== Vector Basic Tests ===\n\n");
@@ -93,11 +100,21 @@ void testVectorResize() {
 
     printf("✓ Vector resized correctly during push\n\n");
 
-    // Test shrinking during pop
+    // By default pop never gives capacity back
     printf("Test 5: Testing automatic shrinking\n");
     int initial_capacity = vec->capacity;
 
-    // Pop most elements to trigger shrinking
+    while (vec->size > 2) {
+        vector_pop(vec);
+    }
+    assert(vec->capacity == initial_capacity);
+
+    // With the hysteresis policy, popping most elements triggers shrinking
+    for (int i = vec->size; i < 20; i++) {
+        vector_push(vec, i * 10);
+    }
+    vector_set_shrink_policy(vec, VECTOR_SHRINK_HYSTERESIS);
+
     while (vec->size > 2) {
         vector_pop(vec);
     }
@@ -343,6 +360,769 @@ void testVectorComprehensive() {
     printf("✓ Comprehensive test passed\n\n");
 }
 
+void testVectorSmallBuffer() {
+    printf("Test 14: Testing inline small buffer\n");
+
+    // Stack vector never touches the heap while it fits the inline buffer
+    struct vector vec;
+    vector_init(&vec);
+    for (int i = 0; i < VECTOR_INLINE_CAPACITY; i++) {
+        vector_push(&vec, i);
+    }
+    assert(vec.head == vec.inline_buffer);
+    assert(vec.capacity == VECTOR_INLINE_CAPACITY);
+
+    // Outgrowing it moves the elements to the heap
+    vector_push(&vec, 100);
+    assert(vec.head != vec.inline_buffer);
+    assert(vec.capacity > VECTOR_INLINE_CAPACITY);
+    for (int i = 0; i < VECTOR_INLINE_CAPACITY; i++) {
+        assert(*vector_at(&vec, i) == i);
+    }
+    assert(*vector_at(&vec, VECTOR_INLINE_CAPACITY) == 100);
+
+    // Shrinking back down returns to the inline buffer
+    while (vec.size > 2) {
+        vector_pop(&vec);
+    }
+    vector_shrink_to_fit(&vec);
+    assert(vec.head == vec.inline_buffer);
+    assert(*vector_at(&vec, 0) == 0);
+    assert(*vector_at(&vec, 1) == 1);
+
+    vector_destroy(&vec);
+
+    // Pushing onto a wrapped array copies it out instead of reallocating memory we don't own
+    int array[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    struct vector* wrapped_vec = vector_wrap_array(10, array);
+    vector_push(wrapped_vec, 11);
+    assert(wrapped_vec->is_wrapping == false);
+    assert(wrapped_vec->head != array);
+    assert(*vector_at(wrapped_vec, 10) == 11);
+    assert(array[9] == 10);
+    vector_free(wrapped_vec);
+
+    printf("✓ Inline small buffer working correctly\n\n");
+}
+
+void testVectorGrowthAndReserve() {
+    printf("Test 15: Testing growth factor, reserve and shrink_to_fit\n");
+
+    struct vector* vec = vector_new();
+    vector_set_growth_factor(vec, VECTOR_GROWTH_FACTOR_COMPACT);
+    for (int i = 0; i < VECTOR_INLINE_CAPACITY + 1; i++) {
+        vector_push(vec, i);
+    }
+    assert(vec->capacity == (int) (VECTOR_INLINE_CAPACITY * VECTOR_GROWTH_FACTOR_COMPACT));
+
+    // Factors that wouldn't grow are ignored
+    vector_set_growth_factor(vec, 1.0);
+    assert(vec->growth_factor == VECTOR_GROWTH_FACTOR_COMPACT);
+
+    vector_reserve(vec, 1000);
+    assert(vec->capacity == 1000);
+    vector_type* head = vec->head;
+    for (int i = vec->size; i < 1000; i++) {
+        vector_push(vec, i);
+    }
+    assert(vec->head == head); // No reallocation within the reserved capacity
+
+    // Reserving less than the capacity does nothing
+    vector_reserve(vec, 10);
+    assert(vec->capacity == 1000);
+
+    while (vec->size > 500) {
+        vector_pop(vec);
+    }
+    vector_shrink_to_fit(vec);
+    assert(vec->capacity == vec->size);
+    for (int i = 0; i < vec->size; i++) {
+        assert(*vector_at(vec, i) == i);
+    }
+
+    vector_free(vec);
+    printf("✓ Growth factor, reserve and shrink_to_fit working correctly\n\n");
+}
+
+void testVectorShrinkPolicy() {
+    printf("Test 16: Testing shrink policy hysteresis and vector_trim\n");
+
+    struct vector* vec = vector_new();
+    vector_set_shrink_policy(vec, VECTOR_SHRINK_HYSTERESIS);
+    for (int i = 0; i < 64; i++) {
+        vector_push(vec, i);
+    }
+    assert(vec->capacity == 64);
+
+    // Oscillating around any size must not reallocate on every step
+    int capacity_changes = 0;
+    int last_capacity = vec->capacity;
+    for (int i = 0; i < 1000; i++) {
+        if (i % 2 == 0) {
+            vector_pop(vec);
+        } else {
+            vector_push(vec, i);
+        }
+        if (vec->capacity != last_capacity) {
+            capacity_changes++;
+            last_capacity = vec->capacity;
+        }
+    }
+    assert(capacity_changes <= 1);
+
+    // Once shrunk, the vector is left half full
+    while (vec->size > 16) {
+        vector_pop(vec);
+    }
+    assert(vec->capacity == 32);
+    for (int i = 0; i < 1000; i++) {
+        if (i % 2 == 0) {
+            vector_push(vec, i);
+        } else {
+            vector_pop(vec);
+        }
+    }
+    assert(vec->capacity == 32);
+
+    // trim releases capacity without shrinking all the way down to size
+    struct vector* trimmed = vector_new();
+    for (int i = 0; i < 1000; i++) {
+        vector_push(trimmed, i);
+    }
+    while (trimmed->size > 100) {
+        vector_pop(trimmed);
+    }
+    assert(trimmed->capacity == 1024);
+    vector_trim(trimmed);
+    assert(trimmed->capacity == 256);
+    assert(trimmed->capacity >= trimmed->size * 2);
+    for (int i = 0; i < trimmed->size; i++) {
+        assert(*vector_at(trimmed, i) == i);
+    }
+
+    vector_free(vec);
+    vector_free(trimmed);
+    printf("✓ Shrink policy and vector_trim working correctly\n\n");
+}
+
+void testVectorBulkOperations() {
+    printf("Test 17: Testing bulk append, insert, erase, resize and extend\n");
+
+    struct vector* vec = vector_new();
+    int source[100];
+    for (int i = 0; i < 100; i++) {
+        source[i] = i;
+    }
+
+    vector_append(vec, source, 100);
+    assert(vec->size == 100);
+    for (int i = 0; i < 100; i++) {
+        assert(*vector_at(vec, i) == i);
+    }
+
+    // Insert in the middle, at the front and at the end
+    int inserted[] = {-1, -2, -3};
+    assert(vector_insert_range(vec, 50, inserted, 3));
+    assert(vec->size == 103);
+    assert(*vector_at(vec, 49) == 49);
+    assert(*vector_at(vec, 50) == -1);
+    assert(*vector_at(vec, 52) == -3);
+    assert(*vector_at(vec, 53) == 50);
+    assert(vector_insert_range(vec, 0, inserted, 1));
+    assert(*vector_at(vec, 0) == -1);
+    assert(vector_insert_range(vec, vec->size, inserted + 2, 1));
+    assert(*vector_at(vec, vec->size - 1) == -3);
+    assert(!vector_insert_range(vec, vec->size + 1, inserted, 1));
+    assert(!vector_insert_range(vec, -1, inserted, 1));
+
+    // Erase them back out
+    assert(vector_erase_range(vec, vec->size - 1, vec->size));
+    assert(vector_erase_range(vec, 0, 1));
+    assert(vector_erase_range(vec, 50, 53));
+    assert(vec->size == 100);
+    for (int i = 0; i < 100; i++) {
+        assert(*vector_at(vec, i) == i);
+    }
+    assert(!vector_erase_range(vec, 10, 5));
+    assert(!vector_erase_range(vec, 0, 101));
+
+    // Resize up fills, resize down truncates
+    vector_resize(vec, 150, 7);
+    assert(vec->size == 150);
+    assert(*vector_at(vec, 99) == 99);
+    assert(*vector_at(vec, 100) == 7);
+    assert(*vector_at(vec, 149) == 7);
+    vector_resize(vec, 10, 0);
+    assert(vec->size == 10);
+    assert(*vector_at(vec, 9) == 9);
+
+    // Extending and inserting from itself, which moves the buffer while copying from it
+    vector_extend(vec, vec);
+    assert(vec->size == 20);
+    for (int i = 0; i < 20; i++) {
+        assert(*vector_at(vec, i) == i % 10);
+    }
+    assert(vector_insert_range(vec, 0, vec->head + 5, 10));
+    assert(vec->size == 30);
+    for (int i = 0; i < 10; i++) {
+        assert(*vector_at(vec, i) == (i + 5) % 10);
+    }
+
+    struct vector* other = vector_deep_copy_array(100, source);
+    vector_extend(vec, other);
+    assert(vec->size == 130);
+    assert(*vector_at(vec, 129) == 99);
+
+    vector_free(other);
+    vector_free(vec);
+    printf("✓ Bulk operations working correctly\n\n");
+}
+
+void testVectorSimdKernels() {
+    printf("Test 18: Testing SIMD search, reduce and transform kernels\n");
+
+    const enum vector_simd_level default_level = vector_simd_get_level();
+    const enum vector_simd_level levels[] = {VECTOR_SIMD_SCALAR, VECTOR_SIMD_SSE42, VECTOR_SIMD_AVX2};
+
+    for (int l = 0; l < 3; l++) {
+        const enum vector_simd_level level = vector_simd_set_level(levels[l]);
+        printf("  Testing level %i\n", level);
+
+        // Odd sizes so the scalar tails get exercised too
+        for (int size = 0; size < 40; size += 3) {
+            struct vector* vec = vector_new();
+            long long expected_sum = 0;
+            for (int i = 0; i < size; i++) {
+                const vector_type value = (i * 7919) % 101 - 50;
+                vector_push(vec, value);
+                expected_sum += value;
+            }
+
+            assert(vector_sum(vec) == expected_sum);
+            assert(vector_find(vec, 1000) == -1);
+            assert(vector_count(vec, 1000) == 0);
+
+            if (size == 0) {
+                assert(vector_min(vec).is_null);
+                assert(vector_max(vec).is_null);
+                vector_free(vec);
+                continue;
+            }
+
+            vector_type min = vec->head[0];
+            vector_type max = vec->head[0];
+            for (int i = 0; i < size; i++) {
+                if (vec->head[i] < min) min = vec->head[i];
+                if (vec->head[i] > max) max = vec->head[i];
+            }
+            assert(vector_min(vec).data == min);
+            assert(vector_max(vec).data == max);
+
+            const vector_type last = vec->head[size - 1];
+            int expected_count = 0;
+            int expected_index = -1;
+            for (int i = 0; i < size; i++) {
+                if (vec->head[i] == last) {
+                    expected_count++;
+                    if (expected_index == -1) expected_index = i;
+                }
+            }
+            assert(vector_find(vec, last) == expected_index);
+            assert(vector_count(vec, last) == expected_count);
+
+            struct vector* other = vector_clone(vec);
+            vector_add_scalar(other, 3);
+            vector_mul_scalar(other, -2);
+            for (int i = 0; i < size; i++) {
+                assert(other->head[i] == (vec->head[i] + 3) * -2);
+            }
+            assert(vector_add(other, vec));
+            for (int i = 0; i < size; i++) {
+                assert(other->head[i] == (vec->head[i] + 3) * -2 + vec->head[i]);
+            }
+
+            vector_push(other, 0);
+            assert(!vector_add(other, vec));
+
+            vector_free(other);
+            vector_free(vec);
+        }
+    }
+
+    vector_simd_set_level(default_level);
+    printf("✓ SIMD kernels working correctly\n\n");
+}
+
+static int compare_vector_type(const void* a, const void* b) {
+    const vector_type l = *(const vector_type*) a;
+    const vector_type r = *(const vector_type*) b;
+    return (l > r) - (l < r);
+}
+
+void testVectorSort() {
+    printf("Test 19: Testing radix sort, parallel sort and binary search\n");
+
+    const int sizes[] = {0, 1, 10, 63, 64, 1000, 100000};
+    for (int s = 0; s < 7; s++) {
+        const int size = sizes[s];
+        struct vector* vec = vector_new();
+        unsigned int seed = 12345;
+        for (int i = 0; i < size; i++) {
+            seed = seed * 1103515245 + 12345;
+            vector_push(vec, (vector_type) seed); // Covers negatives and the full int range
+        }
+
+        struct vector* expected = vector_clone(vec);
+        qsort(expected->head, expected->size, sizeof(vector_type), compare_vector_type);
+
+        struct vector* parallel = vector_clone(vec);
+        vector_sort(vec);
+        vector_sort_parallel(parallel, 3);
+
+        for (int i = 0; i < size; i++) {
+            assert(vec->head[i] == expected->head[i]);
+            assert(parallel->head[i] == expected->head[i]);
+        }
+
+        vector_free(expected);
+        vector_free(parallel);
+        vector_free(vec);
+    }
+
+    // Narrow value ranges skip radix passes
+    struct vector* small_values = vector_new();
+    for (int i = 0; i < 5000; i++) {
+        vector_push(small_values, (i * 37) % 200);
+    }
+    vector_sort(small_values);
+    for (int i = 1; i < small_values->size; i++) {
+        assert(small_values->head[i - 1] <= small_values->head[i]);
+    }
+
+    // Searching the sorted vector
+    assert(vector_binary_search(small_values, 150) != -1);
+    assert(small_values->head[vector_binary_search(small_values, 150)] == 150);
+    assert(vector_binary_search(small_values, 200) == -1);
+    assert(vector_binary_search(small_values, -1) == -1);
+    assert(vector_lower_bound(small_values, -1) == 0);
+    assert(vector_lower_bound(small_values, 1000) == small_values->size);
+    const int first_ten = vector_lower_bound(small_values, 10);
+    assert(small_values->head[first_ten] == 10);
+    assert(small_values->head[first_ten - 1] == 9);
+
+    vector_free(small_values);
+    printf("✓ Sorting and searching working correctly\n\n");
+}
+
+struct test_point {
+    double x;
+    double y;
+    long long id;
+};
+
+struct test_named {
+    char* name;
+};
+
+static int test_named_releases = 0;
+
+static void test_named_copy(struct test_named* destination, const struct test_named* source) {
+    destination->name = strdup(source->name);
+}
+
+static void test_named_release(struct test_named* element) {
+    free(element->name);
+    test_named_releases++;
+}
+
+VECTOR_DEFINE(vector_double, double)
+VECTOR_DEFINE(vector_u64, unsigned long long)
+VECTOR_DEFINE(vector_point, struct test_point)
+VECTOR_DEFINE(vector_ptr, void*)
+VECTOR_DEFINE_WITH_COPY(vector_named, struct test_named, test_named_copy, test_named_release)
+
+void testVectorTemplate() {
+    printf("Test 20: Testing type specialized vectors\n");
+
+    struct vector_double doubles;
+    vector_double_init(&doubles);
+    for (int i = 0; i < 1000; i++) {
+        vector_double_push(&doubles, i * 0.5);
+    }
+    assert(doubles.size == 1000);
+    assert(*vector_double_at(&doubles, 999) == 499.5);
+    assert(vector_double_at(&doubles, 1000) == NULL);
+    double popped;
+    assert(vector_double_pop(&doubles, &popped));
+    assert(popped == 499.5);
+    vector_double_destroy(&doubles);
+    assert(!vector_double_pop(&doubles, NULL));
+
+    struct vector_u64 ids;
+    vector_u64_init(&ids);
+    const unsigned long long source_ids[] = {1ULL << 40, 1ULL << 50, ~0ULL};
+    vector_u64_append(&ids, source_ids, 3);
+    assert(*vector_u64_at(&ids, 2) == ~0ULL);
+    vector_u64_destroy(&ids);
+
+    // Appending the vector's own elements across a growth, the source moves with the buffer
+    struct vector_double self;
+    vector_double_init(&self);
+    for (int i = 0; i < 8; i++) {
+        vector_double_push(&self, i);
+    }
+    assert(self.size == self.capacity);
+    vector_double_append(&self, self.head, self.size);
+    assert(self.size == 16 && *vector_double_at(&self, 15) == 7);
+    vector_double_append(&self, self.head + 12, 4); // part of itself, growing again
+    assert(self.size == 20 && *vector_double_at(&self, 16) == 4 && *vector_double_at(&self, 19) == 7);
+    vector_double_destroy(&self);
+
+    struct vector_point points;
+    vector_point_init(&points);
+    vector_point_push(&points, (struct test_point) {1.0, 2.0, 3});
+    vector_point_push(&points, (struct test_point) {4.0, 5.0, 6});
+    struct vector_point points_copy;
+    vector_point_init(&points_copy);
+    vector_point_clone_into(&points_copy, &points);
+    assert(points_copy.size == 2);
+    assert(points_copy.head != points.head);
+    assert(vector_point_at(&points_copy, 1)->id == 6);
+    vector_point_destroy(&points);
+    vector_point_destroy(&points_copy);
+
+    struct vector_ptr pointers;
+    vector_ptr_init(&pointers);
+    vector_ptr_push(&pointers, &popped);
+    assert(*vector_ptr_at(&pointers, 0) == &popped);
+    vector_ptr_destroy(&pointers);
+
+    // Copy function deep copies on append, release frees whatever the vector drops
+    struct vector_named names;
+    vector_named_init(&names);
+    struct test_named source_names[] = {{"a"}, {"b"}, {"c"}};
+    vector_named_append(&names, source_names, 3);
+    assert(vector_named_at(&names, 1)->name != source_names[1].name);
+    assert(strcmp(vector_named_at(&names, 1)->name, "b") == 0);
+
+    struct test_named popped_name;
+    assert(vector_named_pop(&names, &popped_name)); // handed back, not released
+    assert(test_named_releases == 0 && strcmp(popped_name.name, "c") == 0);
+    free(popped_name.name);
+    assert(vector_named_pop(&names, NULL));
+    assert(test_named_releases == 1 && names.size == 1);
+
+    struct vector_named names_copy;
+    vector_named_init(&names_copy);
+    vector_named_append(&names_copy, source_names, 3);
+    vector_named_clone_into(&names_copy, &names); // the three it held are released first
+    assert(test_named_releases == 4 && names_copy.size == 1);
+    assert(strcmp(vector_named_at(&names_copy, 0)->name, "a") == 0);
+
+    vector_named_destroy(&names);
+    vector_named_destroy(&names_copy);
+    assert(test_named_releases == 6);
+
+    printf("✓ Type specialized vectors working correctly\n\n");
+}
+
+// Runs action in a child process, its exit code or -1 if it died of a signal
+static int exit_code_of_child(void (*action)(struct vector*), struct vector* vector) {
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        freopen("/dev/null", "w", stdout); // the error message is expected
+        action(vector);
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static void push_one(struct vector* vector) {
+    vector_push(vector, 1);
+}
+
+static void pop_one(struct vector* vector) {
+    vector_pop(vector);
+}
+
+static void sort_all(struct vector* vector) {
+    vector_sort(vector);
+}
+
+void testVectorMmap() {
+    printf("Test 21: Testing file backed vectors\n");
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/vector_test_%i.bin", (int) getpid());
+
+    struct vector* vec = vector_open_mmap(path, VECTOR_MMAP_TRUNCATE);
+    assert(vec != NULL);
+    assert(vec->size == 0);
+    assert(vec->is_wrapping == true);
+
+    // Grows the file well past the initial mapping
+    for (int i = 0; i < 100000; i++) {
+        vector_push(vec, i);
+    }
+    int more[] = {-1, -2, -3};
+    vector_append(vec, more, 3);
+    assert(vector_sync(vec));
+    vector_free(vec);
+
+    // Reopening sees everything that was pushed
+    vec = vector_open_mmap(path, VECTOR_MMAP_READ_WRITE);
+    assert(vec != NULL);
+    assert(vec->size == 100003);
+    for (int i = 0; i < 100000; i++) {
+        assert(*vector_at(vec, i) == i);
+    }
+    assert(*vector_at(vec, 100002) == -3);
+    vector_pop(vec);
+    vector_free(vec); // Closing stores the size too
+
+    vec = vector_open_mmap(path, VECTOR_MMAP_READ_ONLY);
+    assert(vec != NULL);
+    assert(vec->size == 100002);
+    assert(vector_sum(vec) == 4999950000LL - 3);
+
+    // Writes fail cleanly, even when the size is below the page rounded capacity
+    assert(vec->size < vec->capacity);
+    assert(exit_code_of_child(push_one, vec) == 1);
+    assert(exit_code_of_child(sort_all, vec) == 1);
+    assert(exit_code_of_child(pop_one, vec) == 1);
+
+    // Clones of a mapped vector live on the heap
+    struct vector* clone = vector_clone(vec);
+    assert(clone->mapping == NULL);
+    vector_push(clone, 5);
+    assert(clone->size == 100003);
+    vector_free(clone);
+    vector_free(vec);
+
+    // Truncating starts over
+    vec = vector_open_mmap(path, VECTOR_MMAP_TRUNCATE);
+    assert(vec->size == 0);
+    vector_free(vec);
+
+    unlink(path);
+    assert(vector_open_mmap(path, VECTOR_MMAP_READ_ONLY) == NULL);
+    assert(vector_open_mmap("/nonexistent/vector.bin", VECTOR_MMAP_READ_WRITE) == NULL);
+
+    printf("✓ File backed vectors working correctly\n\n");
+}
+
+static long long sum_view(struct vector_view view) {
+    long long sum = 0;
+    for (int i = 0; i < view.size; i++) {
+        sum += *vector_view_at(view, i);
+    }
+    return sum;
+}
+
+void testVectorViewsAndCow() {
+    printf("Test 22: Testing views, slices and copy on write clones\n");
+
+    struct vector* vec = vector_new();
+    for (int i = 0; i < 100; i++) {
+        vector_push(vec, i);
+    }
+
+    // Views point straight into the vector
+    struct vector_view all = vector_view_of(vec);
+    assert(all.head == vec->head);
+    assert(all.size == 100);
+    assert(sum_view(all) == 4950);
+
+    struct vector_view middle = vector_slice(vec, 10, 20);
+    assert(middle.head == vec->head + 10);
+    assert(middle.size == 10);
+    assert(*vector_view_at(middle, 0) == 10);
+    assert(vector_view_at(middle, 10) == NULL);
+    assert(sum_view(middle) == 145);
+
+    struct vector_view inner = vector_view_slice(middle, 2, 4);
+    assert(*vector_view_at(inner, 0) == 12);
+    assert(inner.size == 2);
+
+    assert(vector_slice(vec, 50, 101).size == 0);
+    assert(vector_slice(vec, 20, 10).size == 0);
+    assert(vector_slice(vec, 10, 10).size == 0);
+
+    struct vector* copied = vector_from_view(middle);
+    assert(copied->size == 10);
+    assert(copied->head != vec->head + 10);
+    assert(*vector_at(copied, 9) == 19);
+    vector_free(copied);
+
+    // Copy on write clones share the buffer until one of them is modified
+    struct vector* clone = vector_clone_cow(vec);
+    assert(clone->head == vec->head);
+    assert(clone->size == 100);
+    struct vector* clone2 = vector_clone_cow(clone);
+    assert(clone2->head == vec->head);
+
+    vector_push(clone, 100);
+    assert(clone->head != vec->head);
+    assert(clone->size == 101);
+    assert(vec->size == 100);
+    assert(clone2->head == vec->head);
+
+    vector_add_scalar(vec, 1);
+    assert(vec->head != clone2->head);
+    assert(*vector_at(vec, 0) == 1);
+    assert(*vector_at(clone2, 0) == 0);
+
+    // clone2 is the last one holding the buffer, writing no longer copies
+    vector_type* head = clone2->head;
+    vector_make_unique(clone2);
+    assert(clone2->head == head);
+    assert(clone2->shared == NULL);
+
+    // Freeing in any order releases the buffer exactly once
+    struct vector* clone3 = vector_clone_cow(clone2);
+    vector_free(clone2);
+    assert(*vector_at(clone3, 99) == 99);
+    vector_erase_range(clone3, 0, 50);
+    assert(*vector_at(clone3, 0) == 50);
+
+    // Small vectors are copied straight away
+    struct vector* small = vector_new();
+    vector_push(small, 1);
+    struct vector* small_clone = vector_clone_cow(small);
+    assert(small_clone->head != small->head);
+
+    vector_free(small);
+    vector_free(small_clone);
+    vector_free(clone3);
+    vector_free(clone);
+    vector_free(vec);
+    printf("✓ Views, slices and copy on write clones working correctly\n\n");
+}
+
+#define CONCURRENT_TEST_THREADS 4
+#define CONCURRENT_TEST_PUSHES 100000
+
+struct concurrent_test_args {
+    struct concurrent_vector* vector;
+    int thread_index;
+};
+
+static void* concurrent_test_push(void* arg) {
+    const struct concurrent_test_args* args = arg;
+    const int base = args->thread_index * CONCURRENT_TEST_PUSHES;
+
+    for (int i = 0; i < CONCURRENT_TEST_PUSHES; i += 2) {
+        const int index = concurrent_vector_push(args->vector, base + i);
+        assert(*concurrent_vector_at(args->vector, index) == base + i);
+
+        const vector_type next = base + i + 1;
+        concurrent_vector_append(args->vector, &next, 1);
+    }
+    return NULL;
+}
+
+void testConcurrentVector() {
+    printf("Test 23: Testing concurrent append vector\n");
+
+    struct concurrent_vector* vec = concurrent_vector_new();
+    assert(concurrent_vector_size(vec) == 0);
+    assert(concurrent_vector_at(vec, 0) == NULL);
+
+    // Pointers stay valid as the vector grows
+    concurrent_vector_push(vec, -1);
+    vector_type* first = concurrent_vector_at(vec, 0);
+
+    pthread_t threads[CONCURRENT_TEST_THREADS];
+    struct concurrent_test_args args[CONCURRENT_TEST_THREADS];
+    for (int i = 0; i < CONCURRENT_TEST_THREADS; i++) {
+        args[i] = (struct concurrent_test_args) {vec, i};
+        pthread_create(&threads[i], NULL, concurrent_test_push, &args[i]);
+    }
+    for (int i = 0; i < CONCURRENT_TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    const int total = CONCURRENT_TEST_THREADS * CONCURRENT_TEST_PUSHES;
+    assert(concurrent_vector_size(vec) == total + 1);
+    assert(concurrent_vector_at(vec, 0) == first);
+    assert(*first == -1);
+
+    // Every pushed value shows up exactly once
+    bool* seen = calloc(total, sizeof(bool));
+    for (int i = 1; i <= total; i++) {
+        const vector_type value = *concurrent_vector_at(vec, i);
+        assert(value >= 0 && value < total);
+        assert(!seen[value]);
+        seen[value] = true;
+    }
+    free(seen);
+
+    // Bulk appends spanning several segments
+    int source[1000];
+    for (int i = 0; i < 1000; i++) {
+        source[i] = i;
+    }
+    const int start = concurrent_vector_append(vec, source, 1000);
+    assert(start == total + 1);
+    for (int i = 0; i < 1000; i++) {
+        assert(*concurrent_vector_at(vec, start + i) == i);
+    }
+    assert(concurrent_vector_at(vec, start + 1000) == NULL);
+
+    concurrent_vector_free(vec);
+    printf("✓ Concurrent append vector working correctly\n\n");
+}
+
+void testVectorDeque() {
+    printf("Test 24: Testing ring buffer deque\n");
+
+    struct vector_deque* deque = vector_deque_new();
+    assert(vector_deque_pop_front(deque).is_null);
+    assert(vector_deque_pop_back(deque).is_null);
+
+    // Used as a queue, the front keeps wrapping around without growing
+    for (int i = 0; i < 1000; i++) {
+        vector_deque_push_back(deque, i);
+        struct vector_type_nullable popped = vector_deque_pop_front(deque);
+        assert(!popped.is_null);
+        assert(popped.data == i);
+    }
+    assert(deque->capacity == 8);
+
+    // Both ends at once, past a few resizes
+    for (int i = 0; i < 100; i++) {
+        vector_deque_push_back(deque, i);
+        vector_deque_push_front(deque, -i - 1);
+    }
+    assert(deque->size == 200);
+    assert((deque->capacity & (deque->capacity - 1)) == 0);
+    for (int i = 0; i < 200; i++) {
+        assert(*vector_deque_at(deque, i) == i - 100);
+    }
+    assert(vector_deque_at(deque, 200) == NULL);
+    assert(vector_deque_pop_front(deque).data == -100);
+    assert(vector_deque_pop_back(deque).data == 99);
+
+    // Draining into an array, across the wrap point
+    int out[300];
+    assert(vector_deque_drain(deque, out, 50) == 50);
+    for (int i = 0; i < 50; i++) {
+        assert(out[i] == i - 99);
+    }
+    assert(vector_deque_drain(deque, out, 300) == 148);
+    assert(out[0] == -49);
+    assert(out[147] == 98);
+    assert(deque->size == 0);
+    assert(vector_deque_drain(deque, out, 10) == 0);
+
+    vector_deque_free(deque);
+    printf("✓ Ring buffer deque working correctly\n\n");
+}
+
 void runAllVectorTests() {
     printf("=== Starting Vector Implementation Tests ===\n\n");
 
@@ -357,6 +1137,17 @@ void runAllVectorTests() {
     testVectorEdgeCases();
     testVectorMemoryManagement();
     testVectorComprehensive();
+    testVectorSmallBuffer();
+    testVectorGrowthAndReserve();
+    testVectorShrinkPolicy();
+    testVectorBulkOperations();
+    testVectorSimdKernels();
+    testVectorSort();
+    testVectorTemplate();
+    testVectorMmap();
+    testVectorViewsAndCow();
+    testConcurrentVector();
+    testVectorDeque();
 
     printf("🎉 All vector tests completed successfully!\n");
     printf("   Your vector implementation is working correctly.\n");